@@ -0,0 +1,305 @@
+// EchoSphere batch renderer
+//
+// Streams audio files through EchoSphereAudioProcessor with fixed settings, one file
+// per thread-pool job. Files are read and written in blocks, so memory use does not
+// depend on file length.
+
+#include "JuceHeader.h"
+#include "PluginProcessor.h"
+#include "SelfTest.h"
+
+#include <iostream>
+
+namespace EchoSphere
+{
+    namespace BatchRenderer
+    {
+        struct Settings
+        {
+            juce::MemoryBlock state;
+            juce::File impulseResponse;
+            juce::File outputDirectory;
+            juce::String suffix = "_echosphere";
+            int blockSize = 1024;
+            bool renderTail = true;
+        };
+
+        juce::CriticalSection consoleLock;
+
+        void log(const juce::String& message)
+        {
+            const juce::ScopedLock sl(consoleLock);
+            std::cout << message << std::endl;
+        }
+
+        // Accept either the binary blob getStateInformation produces or its plain XML
+        bool loadStateFile(const juce::File& file, juce::MemoryBlock& destData)
+        {
+            juce::MemoryBlock data;
+
+            if (!file.loadFileAsData(data) || data.getSize() == 0)
+                return false;
+
+            if (static_cast<const char*>(data.getData())[0] == '<')
+            {
+                auto xml = juce::parseXML(data.toString());
+
+                if (xml == nullptr)
+                    return false;
+
+                juce::AudioProcessor::copyXmlToBinary(*xml, destData);
+                return true;
+            }
+
+            destData = std::move(data);
+            return true;
+        }
+
+        bool renderFile(const juce::File& input, const Settings& settings)
+        {
+            // Output keeps the input's format and bit depth where the format allows it
+            const auto outputFile = settings.outputDirectory.getChildFile(input.getFileNameWithoutExtension()
+                                                                          + settings.suffix
+                                                                          + input.getFileExtension());
+
+            // An empty suffix into the input's own directory would delete the source unread
+            if (outputFile == input)
+            {
+                log("Skipping " + input.getFullPathName() + ": output would overwrite the input (set --suffix or --output-dir)");
+                return false;
+            }
+
+            juce::AudioFormatManager formatManager;
+            formatManager.registerBasicFormats();
+
+            std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(input));
+
+            if (reader == nullptr)
+            {
+                log("Skipping " + input.getFullPathName() + ": unsupported or unreadable file");
+                return false;
+            }
+
+            const int numChannels = static_cast<int>(reader->numChannels);
+            const double sampleRate = reader->sampleRate;
+
+            if (numChannels < 1 || numChannels > 2)
+            {
+                log("Skipping " + input.getFileName() + ": only mono and stereo files are supported");
+                return false;
+            }
+
+            // Set up a processor instance exactly as a host would for offline bouncing
+            EchoSphereAudioProcessor processor;
+            const auto channelSet = juce::AudioChannelSet::canonicalChannelSet(numChannels);
+
+            juce::AudioProcessor::BusesLayout layout;
+            layout.inputBuses.add(channelSet);
+            layout.outputBuses.add(channelSet);
+
+            if (!processor.setBusesLayout(layout))
+            {
+                log("Skipping " + input.getFileName() + ": channel layout rejected");
+                return false;
+            }
+
+            processor.setNonRealtime(true);
+            processor.setLockDelayMemory(false); // no deadlines offline, and many instances run at once
+            processor.setRateAndBufferSizeDetails(sampleRate, settings.blockSize);
+
+            if (settings.state.getSize() > 0)
+                processor.setStateInformation(settings.state.getData(), static_cast<int>(settings.state.getSize()));
+
+            // Replaces any IR named in the state; partitioned by prepareToPlay below
+            if (settings.impulseResponse != juce::File() && !processor.loadReverbImpulseResponse(settings.impulseResponse))
+            {
+                log("Skipping " + input.getFileName() + ": could not read impulse response " + settings.impulseResponse.getFullPathName());
+                return false;
+            }
+
+            processor.prepareToPlay(sampleRate, settings.blockSize);
+
+            auto* format = formatManager.findFormatForFileExtension(input.getFileExtension());
+            const int bitsPerSample = format != nullptr && format->getPossibleBitDepths().contains(static_cast<int>(reader->bitsPerSample))
+                                          ? static_cast<int>(reader->bitsPerSample)
+                                          : 24;
+
+            outputFile.deleteFile();
+            std::unique_ptr<juce::FileOutputStream> stream(outputFile.createOutputStream());
+            std::unique_ptr<juce::AudioFormatWriter> writer;
+
+            if (format != nullptr && stream != nullptr)
+                writer.reset(format->createWriterFor(stream.get(), sampleRate, static_cast<unsigned int>(numChannels),
+                                                     bitsPerSample, {}, 0));
+
+            if (writer == nullptr)
+            {
+                log("Skipping " + input.getFileName() + ": could not create " + outputFile.getFullPathName());
+                return false;
+            }
+
+            stream.release(); // now owned by the writer
+
+            juce::AudioBuffer<float> buffer(numChannels, settings.blockSize);
+            juce::MidiBuffer midi;
+
+            // Stream the file itself
+            for (juce::int64 position = 0; position < reader->lengthInSamples; position += settings.blockSize)
+            {
+                const auto numSamples = static_cast<int>(juce::jmin(static_cast<juce::int64>(settings.blockSize),
+                                                                    reader->lengthInSamples - position));
+                buffer.setSize(numChannels, numSamples, false, false, true);
+                reader->read(&buffer, 0, numSamples, position, true, numChannels > 1);
+
+                processor.processBlock(buffer, midi);
+                writer->writeFromAudioSampleBuffer(buffer, 0, numSamples);
+            }
+
+            // Then flush the delay and reverb tails with silence
+            if (settings.renderTail)
+            {
+                auto tailRemaining = static_cast<juce::int64>(processor.getTailLengthSeconds() * sampleRate);
+
+                while (tailRemaining > 0)
+                {
+                    const auto numSamples = static_cast<int>(juce::jmin(static_cast<juce::int64>(settings.blockSize), tailRemaining));
+                    buffer.setSize(numChannels, numSamples, false, false, true);
+                    buffer.clear();
+
+                    processor.processBlock(buffer, midi);
+                    writer->writeFromAudioSampleBuffer(buffer, 0, numSamples);
+                    tailRemaining -= numSamples;
+                }
+            }
+
+            processor.releaseResources();
+            log("Rendered " + outputFile.getFullPathName());
+            return true;
+        }
+
+        void printUsage()
+        {
+            log("Usage: EchoSphereRender --state=<file> [options] <input files...>\n"
+                "\n"
+                "Options:\n"
+                "  --state=<file>       Plugin state saved by the host (binary or XML)\n"
+                "  --ir=<file>          Reverb impulse response (overrides any IR named in the state)\n"
+                "  --output-dir=<dir>   Where to write rendered files (default: next to each input)\n"
+                "  --suffix=<text>      Appended to output file names (default: _echosphere)\n"
+                "  --jobs=<n>           Files rendered in parallel (default: number of CPUs)\n"
+                "  --block-size=<n>     Processing block size in samples (default: 1024)\n"
+                "  --no-tail            Do not render the delay/reverb tail past the end of the input\n"
+                "  --self-test          Run the offline DSP checks instead of rendering\n"
+                "  -h, --help           Show this help message");
+        }
+
+        int run(const juce::ArgumentList& args)
+        {
+            if (args.containsOption("--self-test"))
+                return SelfTest::run(log) == 0 ? 0 : 1;
+
+            if (args.containsOption("--help|-h") || args.size() == 0)
+            {
+                printUsage();
+                return 0;
+            }
+
+            Settings settings;
+
+            if (args.containsOption("--state"))
+            {
+                const auto stateFile = juce::File::getCurrentWorkingDirectory().getChildFile(args.getValueForOption("--state"));
+
+                if (!loadStateFile(stateFile, settings.state))
+                {
+                    log("Could not read state file " + stateFile.getFullPathName());
+                    return 1;
+                }
+            }
+
+            if (args.containsOption("--ir"))
+            {
+                settings.impulseResponse = juce::File::getCurrentWorkingDirectory().getChildFile(args.getValueForOption("--ir"));
+
+                if (!settings.impulseResponse.existsAsFile())
+                {
+                    log("Could not find impulse response " + settings.impulseResponse.getFullPathName());
+                    return 1;
+                }
+            }
+
+            if (args.containsOption("--output-dir"))
+            {
+                settings.outputDirectory = juce::File::getCurrentWorkingDirectory().getChildFile(args.getValueForOption("--output-dir"));
+
+                if (!settings.outputDirectory.createDirectory())
+                {
+                    log("Could not create output directory " + settings.outputDirectory.getFullPathName());
+                    return 1;
+                }
+            }
+
+            if (args.containsOption("--suffix"))
+                settings.suffix = args.getValueForOption("--suffix");
+
+            if (args.containsOption("--block-size"))
+                settings.blockSize = juce::jlimit(32, 65536, args.getValueForOption("--block-size").getIntValue());
+
+            settings.renderTail = !args.containsOption("--no-tail");
+
+            const int numJobs = args.containsOption("--jobs")
+                                    ? juce::jmax(1, args.getValueForOption("--jobs").getIntValue())
+                                    : juce::SystemStats::getNumCpus();
+
+            juce::Array<juce::File> inputs;
+
+            for (auto& arg : args.arguments)
+                if (!arg.isOption())
+                    inputs.add(arg.resolveAsFile());
+
+            if (inputs.isEmpty())
+            {
+                printUsage();
+                return 1;
+            }
+
+            std::atomic<int> failures { 0 };
+            const auto startTime = juce::Time::getMillisecondCounterHiRes();
+
+            {
+                juce::ThreadPool pool(juce::jmin(numJobs, inputs.size()));
+
+                for (auto& input : inputs)
+                {
+                    auto fileSettings = settings;
+
+                    if (fileSettings.outputDirectory == juce::File())
+                        fileSettings.outputDirectory = input.getParentDirectory();
+
+                    pool.addJob([input, fileSettings, &failures]
+                    {
+                        if (!renderFile(input, fileSettings))
+                            ++failures;
+                    });
+                }
+
+                while (pool.getNumJobs() > 0)
+                    juce::Thread::sleep(50);
+            }
+
+            const auto elapsedSeconds = (juce::Time::getMillisecondCounterHiRes() - startTime) / 1000.0;
+            log("Rendered " + juce::String(inputs.size() - failures.load()) + " of " + juce::String(inputs.size())
+                + " files in " + juce::String(elapsedSeconds, 2) + " s");
+
+            return failures.load() == 0 ? 0 : 1;
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    // The processor's parameter tree needs a message manager, but nothing here opens a window
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    return EchoSphere::BatchRenderer::run(juce::ArgumentList(argc, argv));
+}
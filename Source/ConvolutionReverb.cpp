@@ -0,0 +1,585 @@
+#include "ConvolutionReverb.h"
+#include "DSPKernels.h"
+
+namespace EchoSphere
+{
+    //==============================================================================
+    ConvolutionReverb::TailWorker::TailWorker(ConvolutionReverb& ownerRef)
+        : juce::Thread("EchoSphere Reverb Tail")
+        , owner(ownerRef)
+        , fft(tailFFTOrder)
+    {
+        for (int channel = 0; channel < maxChannels; ++channel)
+            previousInput[channel].assign(tailPartitionSize, 0.0f);
+
+        workBuffer.assign(2 * tailFFTSize, 0.0f);
+        accumulator.assign(2 * tailFFTSize, 0.0f);
+    }
+
+    void ConvolutionReverb::TailWorker::run()
+    {
+        while (!threadShouldExit())
+        {
+            // Drain every job the audio thread has posted, in order
+            int completed = owner.completedJobs.load(std::memory_order_relaxed);
+
+            while (completed < owner.postedJobs.load(std::memory_order_acquire) && !threadShouldExit())
+            {
+                processJob(owner.tailSlots[completed % numTailSlots]);
+                owner.completedJobs.store(++completed, std::memory_order_release);
+                owner.jobCompleted.signal();
+            }
+
+            wait(-1);
+        }
+    }
+
+    void ConvolutionReverb::TailWorker::processJob(TailSlot& slot)
+    {
+        const auto* kernel = slot.kernel;
+
+        if (kernel == nullptr)
+            return;
+
+        const int numPartitions = kernel->numTailPartitions;
+
+        // A new kernel (or a flushed engine) starts with an empty frequency-domain delay line
+        if (kernel->serial != currentKernelSerial || slot.clearHistory)
+        {
+            for (int channel = 0; channel < maxChannels; ++channel)
+            {
+                fdl[channel].assign(static_cast<size_t>(juce::jmax(1, numPartitions) * tailSpectrumSize), 0.0f);
+                std::fill(previousInput[channel].begin(), previousInput[channel].end(), 0.0f);
+            }
+
+            fdlPosition = 0;
+            currentKernelSerial = kernel->serial;
+        }
+
+        for (int channel = 0; channel < owner.numActiveChannels; ++channel)
+        {
+            auto& output = slot.output[channel];
+
+            if (numPartitions == 0)
+            {
+                std::fill(output.begin(), output.end(), 0.0f);
+                continue;
+            }
+
+            // Overlap-save input: previous Q-block followed by the new one
+            std::copy(previousInput[channel].begin(), previousInput[channel].end(), workBuffer.begin());
+            std::copy(slot.input[channel].begin(), slot.input[channel].end(), workBuffer.begin() + tailPartitionSize);
+            std::fill(workBuffer.begin() + tailFFTSize, workBuffer.end(), 0.0f);
+            std::copy(slot.input[channel].begin(), slot.input[channel].end(), previousInput[channel].begin());
+
+            fft.performRealOnlyForwardTransform(workBuffer.data(), true);
+
+            auto* spectra = fdl[channel].data();
+            std::copy(workBuffer.begin(), workBuffer.begin() + tailSpectrumSize, spectra + fdlPosition * tailSpectrumSize);
+
+            // Sum every stored input spectrum against its matching IR partition
+            const int kernelChannel = juce::jmin(channel, kernel->numChannels - 1);
+            const auto* partitions = kernel->tailSpectra[kernelChannel].data();
+
+            const auto& dsp = Kernels::get();
+            std::fill(accumulator.begin(), accumulator.end(), 0.0f);
+
+            for (int partition = 0; partition < numPartitions; ++partition)
+            {
+                const int index = (fdlPosition - partition + numPartitions) % numPartitions;
+                dsp.complexMultiplyAccumulate(accumulator.data(),
+                                              spectra + index * tailSpectrumSize,
+                                              partitions + partition * tailSpectrumSize,
+                                              tailSpectrumSize / 2);
+            }
+
+            fillSymmetricSpectrum(accumulator.data(), tailFFTSize);
+            fft.performRealOnlyInverseTransform(accumulator.data());
+
+            std::copy(accumulator.begin() + tailPartitionSize, accumulator.begin() + tailFFTSize, output.begin());
+        }
+
+        if (numPartitions > 0)
+            fdlPosition = (fdlPosition + 1) % numPartitions;
+    }
+
+    //==============================================================================
+    ConvolutionReverb::ConvolutionReverb()
+        : headFFT(headFFTOrder)
+        , currentSampleRate(0.0)
+        , numActiveChannels(0)
+        , headFill(0)
+        , tailFill(0)
+        , mix(0.0f)
+        , headFDLPosition(0)
+        , lastPostedJob(-1)
+        , historyClearPending(false)
+        , bypassed(true)
+        , nonRealtime(false)
+    {
+    }
+
+    ConvolutionReverb::~ConvolutionReverb()
+    {
+        release();
+    }
+
+    void ConvolutionReverb::prepare(double sampleRate, int numChannels)
+    {
+        const juce::ScopedLock sl(loaderLock);
+
+        // The worker must be idle while its shared buffers are resized
+        stopTailWorker();
+
+        currentSampleRate = sampleRate;
+        numActiveChannels = juce::jlimit(1, maxChannels, numChannels);
+
+        for (int channel = 0; channel < maxChannels; ++channel)
+        {
+            headInput[channel].assign(2 * headPartitionSize, 0.0f);
+            headOutput[channel].assign(headPartitionSize, 0.0f);
+            headFDL[channel].assign(numHeadPartitions * headSpectrumSize, 0.0f);
+            tailInput[channel].assign(tailPartitionSize, 0.0f);
+            tailPlayback[channel].assign(tailPartitionSize, 0.0f);
+
+            for (auto& slot : tailSlots)
+            {
+                slot.input[channel].assign(tailPartitionSize, 0.0f);
+                slot.output[channel].assign(tailPartitionSize, 0.0f);
+            }
+        }
+
+        headWork.assign(2 * headFFTSize, 0.0f);
+        headAccumulator.assign(2 * headFFTSize, 0.0f);
+        wetScratch.assign(headPartitionSize, 0.0f);
+
+        for (auto& slot : tailSlots)
+        {
+            slot.kernel = nullptr;
+            slot.clearHistory = false;
+        }
+
+        postedJobs.store(0);
+        completedJobs.store(0);
+        missedTailDeadlines.store(0);
+
+        // Every kernel is rebuilt for the new sample rate, so nothing old survives
+        pendingKernel.store(nullptr);
+        activeKernel.store(nullptr);
+        kernels.clear();
+
+        if (sourceImpulse.getNumSamples() == 0)
+        {
+            sourceImpulse = createDefaultImpulse(sampleRate);
+            sourceImpulseSampleRate = sampleRate;
+        }
+
+        auto kernel = buildKernel(sourceImpulse, sourceImpulseSampleRate);
+        kernel->serial = nextKernelSerial++;
+        impulseLengthSeconds.store(kernel->lengthInSamples / sampleRate);
+        activeKernel.store(kernels.add(kernel.release()));
+
+        reset();
+
+        tailWorker = std::make_unique<TailWorker>(*this);
+        tailWorker->startThread(juce::Thread::Priority::high);
+    }
+
+    void ConvolutionReverb::release()
+    {
+        const juce::ScopedLock sl(loaderLock);
+        stopTailWorker();
+    }
+
+    void ConvolutionReverb::stopTailWorker()
+    {
+        if (tailWorker != nullptr)
+        {
+            tailWorker->signalThreadShouldExit();
+            tailWorker->notify();
+            tailWorker->stopThread(1000);
+            tailWorker.reset();
+        }
+    }
+
+    void ConvolutionReverb::loadImpulseResponse(juce::AudioBuffer<float>&& impulse, double impulseSampleRate)
+    {
+        if (impulse.getNumSamples() == 0 || impulse.getNumChannels() == 0 || impulseSampleRate <= 0.0)
+            return;
+
+        const juce::ScopedLock sl(loaderLock);
+
+        sourceImpulse = std::move(impulse);
+        sourceImpulseSampleRate = impulseSampleRate;
+
+        // Not prepared yet - prepare() will partition the new IR
+        if (currentSampleRate <= 0.0)
+            return;
+
+        installKernel(buildKernel(sourceImpulse, sourceImpulseSampleRate));
+    }
+
+    bool ConvolutionReverb::loadImpulseResponse(const juce::File& file)
+    {
+        juce::AudioFormatManager formatManager;
+        formatManager.registerBasicFormats();
+
+        std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(file));
+
+        if (reader == nullptr || reader->sampleRate <= 0.0)
+            return false;
+
+        const auto maxLength = static_cast<juce::int64>(maxImpulseLengthSeconds * reader->sampleRate);
+        const auto length = static_cast<int>(juce::jmin(reader->lengthInSamples, maxLength));
+        const auto numChannels = juce::jlimit(1, maxChannels, static_cast<int>(reader->numChannels));
+
+        if (length <= 0)
+            return false;
+
+        juce::AudioBuffer<float> impulse(numChannels, length);
+        reader->read(&impulse, 0, length, 0, true, numChannels > 1);
+
+        loadImpulseResponse(std::move(impulse), reader->sampleRate);
+        return true;
+    }
+
+    void ConvolutionReverb::installKernel(std::unique_ptr<Kernel> kernel)
+    {
+        deleteRetiredKernels();
+
+        kernel->serial = nextKernelSerial++;
+        impulseLengthSeconds.store(kernel->lengthInSamples / currentSampleRate);
+
+        auto* newKernel = kernels.add(kernel.release());
+
+        // A kernel that was still pending has never been seen by the audio thread
+        if (auto* superseded = pendingKernel.exchange(newKernel))
+            kernels.removeObject(superseded);
+    }
+
+    void ConvolutionReverb::deleteRetiredKernels()
+    {
+        const int completed = completedJobs.load(std::memory_order_acquire);
+
+        for (int i = kernels.size(); --i >= 0;)
+        {
+            const int retiredAfter = kernels[i]->retiredAfterJob.load(std::memory_order_acquire);
+
+            // Jobs are processed in order, so once the worker has passed the swap point
+            // nothing can reference the old kernel any more
+            if (retiredAfter >= 0 && completed >= retiredAfter)
+                kernels.remove(i);
+        }
+    }
+
+    std::unique_ptr<ConvolutionReverb::Kernel> ConvolutionReverb::buildKernel(const juce::AudioBuffer<float>& impulse,
+                                                                              double impulseSampleRate) const
+    {
+        auto kernel = std::make_unique<Kernel>();
+        kernel->numChannels = juce::jlimit(1, maxChannels, impulse.getNumChannels());
+
+        // Resample the IR to the processing rate
+        const double ratio = impulseSampleRate / currentSampleRate;
+        const int maxLength = static_cast<int>(maxImpulseLengthSeconds * currentSampleRate);
+        const int length = juce::jlimit(1, maxLength, static_cast<int>(impulse.getNumSamples() / ratio));
+
+        juce::AudioBuffer<float> resampled(kernel->numChannels, length);
+
+        for (int channel = 0; channel < kernel->numChannels; ++channel)
+        {
+            if (std::abs(ratio - 1.0) < 1.0e-9)
+            {
+                resampled.copyFrom(channel, 0, impulse, channel, 0, juce::jmin(length, impulse.getNumSamples()));
+                continue;
+            }
+
+            // Pad the source so the interpolator never reads past its end
+            std::vector<float> padded(static_cast<size_t>(impulse.getNumSamples() + 8), 0.0f);
+            std::copy(impulse.getReadPointer(channel), impulse.getReadPointer(channel) + impulse.getNumSamples(), padded.begin());
+
+            juce::LagrangeInterpolator interpolator;
+            interpolator.process(ratio, padded.data(), resampled.getWritePointer(channel), length);
+        }
+
+        kernel->lengthInSamples = length;
+        kernel->numTailPartitions = juce::jmax(0, (length - 2 * tailPartitionSize + tailPartitionSize - 1) / tailPartitionSize);
+
+        juce::dsp::FFT headTransform(headFFTOrder);
+        juce::dsp::FFT tailTransform(tailFFTOrder);
+        std::vector<float> work(2 * tailFFTSize, 0.0f);
+
+        // Zero-pads one partition of the IR and stores its half spectrum
+        auto transformPartition = [&](juce::dsp::FFT& transform, const float* source, int start, int partitionSize,
+                                      int spectrumSize, float* destination)
+        {
+            std::fill(work.begin(), work.end(), 0.0f);
+            const int count = juce::jlimit(0, partitionSize, length - start);
+
+            if (count > 0)
+                std::copy(source + start, source + start + count, work.begin());
+
+            transform.performRealOnlyForwardTransform(work.data(), true);
+            std::copy(work.begin(), work.begin() + spectrumSize, destination);
+        };
+
+        for (int channel = 0; channel < kernel->numChannels; ++channel)
+        {
+            const auto* source = resampled.getReadPointer(channel);
+
+            // Direct taps are stored reversed so the audio thread runs a forward dot product
+            auto& direct = kernel->direct[channel];
+            direct.assign(headPartitionSize, 0.0f);
+
+            for (int i = 0; i < juce::jmin(headPartitionSize, length); ++i)
+                direct[static_cast<size_t>(headPartitionSize - 1 - i)] = source[i];
+
+            auto& head = kernel->headSpectra[channel];
+            head.assign(numHeadPartitions * headSpectrumSize, 0.0f);
+
+            for (int partition = 0; partition < numHeadPartitions; ++partition)
+                transformPartition(headTransform, source, headPartitionSize * (partition + 1), headPartitionSize,
+                                   headSpectrumSize, head.data() + partition * headSpectrumSize);
+
+            auto& tail = kernel->tailSpectra[channel];
+            tail.assign(static_cast<size_t>(kernel->numTailPartitions * tailSpectrumSize), 0.0f);
+
+            for (int partition = 0; partition < kernel->numTailPartitions; ++partition)
+                transformPartition(tailTransform, source, tailPartitionSize * (partition + 2), tailPartitionSize,
+                                   tailSpectrumSize, tail.data() + partition * tailSpectrumSize);
+        }
+
+        return kernel;
+    }
+
+    juce::AudioBuffer<float> ConvolutionReverb::createDefaultImpulse(double sampleRate)
+    {
+        // Decorrelated exponentially decaying noise, 2.5 s RT60, normalised to unit energy
+        const double rt60 = 2.5;
+        const int length = static_cast<int>(rt60 * sampleRate);
+        juce::AudioBuffer<float> impulse(maxChannels, length);
+        juce::Random random(0x45636830);
+
+        for (int channel = 0; channel < maxChannels; ++channel)
+        {
+            auto* data = impulse.getWritePointer(channel);
+            double energy = 0.0;
+
+            for (int i = 0; i < length; ++i)
+            {
+                const double envelope = std::exp(-6.9077552789821 * i / (rt60 * sampleRate));
+                data[i] = static_cast<float>((random.nextFloat() * 2.0f - 1.0f) * envelope);
+                energy += static_cast<double>(data[i]) * data[i];
+            }
+
+            if (energy > 0.0)
+                juce::FloatVectorOperations::multiply(data, static_cast<float>(1.0 / std::sqrt(energy)), length);
+        }
+
+        return impulse;
+    }
+
+    void ConvolutionReverb::setMix(float wetDryMix)
+    {
+        // Clamp mix to valid range
+        mix = juce::jlimit(0.0f, 1.0f, wetDryMix / 100.0f);
+    }
+
+    void ConvolutionReverb::reset()
+    {
+        for (int channel = 0; channel < maxChannels; ++channel)
+        {
+            std::fill(headInput[channel].begin(), headInput[channel].end(), 0.0f);
+            std::fill(headOutput[channel].begin(), headOutput[channel].end(), 0.0f);
+            std::fill(headFDL[channel].begin(), headFDL[channel].end(), 0.0f);
+            std::fill(tailInput[channel].begin(), tailInput[channel].end(), 0.0f);
+            std::fill(tailPlayback[channel].begin(), tailPlayback[channel].end(), 0.0f);
+        }
+
+        headFill = 0;
+        tailFill = 0;
+        headFDLPosition = 0;
+        lastPostedJob = -1;
+        historyClearPending = true;
+    }
+
+    void ConvolutionReverb::processBlock(juce::AudioBuffer<float>& buffer)
+    {
+        const auto* kernel = activeKernel.load(std::memory_order_acquire);
+
+        // Fully dry (or not prepared): skip the convolution entirely
+        if (mix <= 0.0f || kernel == nullptr || tailWorker == nullptr)
+        {
+            bypassed = true;
+            return;
+        }
+
+        // History is stale after a bypassed stretch
+        if (bypassed)
+        {
+            reset();
+            bypassed = false;
+        }
+
+        const int numChannels = juce::jmin(buffer.getNumChannels(), numActiveChannels);
+        const int numSamples = buffer.getNumSamples();
+        const float dryGain = 1.0f - mix;
+        const auto& dsp = Kernels::get();
+        auto* wet = wetScratch.data();
+
+        for (int start = 0; start < numSamples;)
+        {
+            // Run up to the next head boundary (tail boundaries always coincide with one)
+            const int count = juce::jmin(numSamples - start, headPartitionSize - headFill);
+
+            for (int channel = 0; channel < numChannels; ++channel)
+            {
+                auto* data = buffer.getWritePointer(channel, start);
+                auto* history = headInput[channel].data() + headPartitionSize + headFill;
+                const auto* direct = kernel->direct[juce::jmin(channel, kernel->numChannels - 1)].data();
+                const auto* fftHead = headOutput[channel].data() + headFill;
+                const auto* fftTail = tailPlayback[channel].data() + tailFill;
+
+                std::copy(data, data + count, history);
+                std::copy(data, data + count, tailInput[channel].data() + tailFill);
+
+                // Direct head: dot product of the reversed taps with the last P inputs
+                for (int i = 0; i < count; ++i)
+                    wet[i] = dsp.dotProduct(direct, history + i - headPartitionSize + 1, headPartitionSize)
+                           + fftHead[i] + fftTail[i];
+
+                dsp.mixDryWet(data, wet, dryGain, mix, count);
+            }
+
+            headFill += count;
+            tailFill += count;
+            start += count;
+
+            if (headFill == headPartitionSize)
+            {
+                for (int channel = 0; channel < numChannels; ++channel)
+                    processHeadPartition(channel);
+
+                headFDLPosition = (headFDLPosition + 1) % numHeadPartitions;
+                headFill = 0;
+            }
+
+            if (tailFill == tailPartitionSize)
+            {
+                onTailBoundary();
+                tailFill = 0;
+                
+                // A new IR may have been swapped in, and the outgoing one can be deleted
+                // by the next load as soon as it is retired
+                kernel = activeKernel.load(std::memory_order_acquire);
+            }
+        }
+    }
+
+    void ConvolutionReverb::processHeadPartition(int channel)
+    {
+        const auto* kernel = activeKernel.load(std::memory_order_relaxed);
+        auto& input = headInput[channel];
+
+        // Spectrum of the last two P-blocks (overlap-save)
+        std::copy(input.begin(), input.end(), headWork.begin());
+        std::fill(headWork.begin() + headFFTSize, headWork.end(), 0.0f);
+        headFFT.performRealOnlyForwardTransform(headWork.data(), true);
+
+        auto* spectra = headFDL[channel].data();
+        std::copy(headWork.begin(), headWork.begin() + headSpectrumSize, spectra + headFDLPosition * headSpectrumSize);
+
+        // The next P-block only needs partitions 1..N, which use inputs we already have.
+        // That is what keeps the head at zero latency.
+        const auto* partitions = kernel->headSpectra[juce::jmin(channel, kernel->numChannels - 1)].data();
+        const auto& dsp = Kernels::get();
+        std::fill(headAccumulator.begin(), headAccumulator.end(), 0.0f);
+
+        for (int partition = 0; partition < numHeadPartitions; ++partition)
+        {
+            const int index = (headFDLPosition - partition + numHeadPartitions) % numHeadPartitions;
+            dsp.complexMultiplyAccumulate(headAccumulator.data(),
+                                          spectra + index * headSpectrumSize,
+                                          partitions + partition * headSpectrumSize,
+                                          headSpectrumSize / 2);
+        }
+
+        fillSymmetricSpectrum(headAccumulator.data(), headFFTSize);
+        headFFT.performRealOnlyInverseTransform(headAccumulator.data());
+
+        std::copy(headAccumulator.begin() + headPartitionSize, headAccumulator.begin() + headFFTSize, headOutput[channel].begin());
+
+        // Current block becomes the previous one
+        std::copy(input.begin() + headPartitionSize, input.end(), input.begin());
+    }
+
+    void ConvolutionReverb::onTailBoundary()
+    {
+        // Offline there is no deadline: wait for the worker rather than drop its output
+        if (nonRealtime && lastPostedJob >= 0)
+        {
+            while (completedJobs.load(std::memory_order_acquire) <= lastPostedJob && tailWorker->isThreadRunning())
+                jobCompleted.wait(10);
+        }
+        
+        // Collect the job posted at the previous boundary - its deadline is now
+        if (lastPostedJob >= 0 && completedJobs.load(std::memory_order_acquire) > lastPostedJob)
+        {
+            const auto& slot = tailSlots[lastPostedJob % numTailSlots];
+
+            for (int channel = 0; channel < numActiveChannels; ++channel)
+                std::copy(slot.output[channel].begin(), slot.output[channel].end(), tailPlayback[channel].begin());
+        }
+        else
+        {
+            if (lastPostedJob >= 0)
+                missedTailDeadlines.fetch_add(1, std::memory_order_relaxed);
+
+            for (int channel = 0; channel < numActiveChannels; ++channel)
+                std::fill(tailPlayback[channel].begin(), tailPlayback[channel].end(), 0.0f);
+        }
+
+        // Pick up a freshly loaded IR. The FDLs hold input spectra only, so they stay valid.
+        if (auto* incoming = pendingKernel.exchange(nullptr, std::memory_order_acq_rel))
+        {
+            auto* outgoing = activeKernel.exchange(incoming, std::memory_order_acq_rel);
+
+            if (outgoing != nullptr)
+                outgoing->retiredAfterJob.store(postedJobs.load(std::memory_order_relaxed), std::memory_order_release);
+        }
+
+        // Hand the completed Q-block to the worker, unless it is hopelessly behind
+        const int posted = postedJobs.load(std::memory_order_relaxed);
+
+        if (posted - completedJobs.load(std::memory_order_acquire) >= numTailSlots)
+        {
+            // The worker's history would be missing this block, so have it start over
+            // from the next one rather than keep convolving a gapped input
+            lastPostedJob = -1;
+            historyClearPending = true;
+            missedTailDeadlines.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        auto& slot = tailSlots[posted % numTailSlots];
+        slot.kernel = activeKernel.load(std::memory_order_relaxed);
+        slot.clearHistory = historyClearPending;
+        historyClearPending = false;
+
+        for (int channel = 0; channel < numActiveChannels; ++channel)
+            std::copy(tailInput[channel].begin(), tailInput[channel].end(), slot.input[channel].begin());
+
+        postedJobs.store(posted + 1, std::memory_order_release);
+        lastPostedJob = posted;
+        tailWorker->notify();
+    }
+
+    void ConvolutionReverb::fillSymmetricSpectrum(float* data, int fftSize)
+    {
+        // Mirror the non-negative bins so every FFT backend sees a full Hermitian spectrum
+        for (int bin = 1; bin < fftSize / 2; ++bin)
+        {
+            data[2 * (fftSize - bin)] = data[2 * bin];
+            data[2 * (fftSize - bin) + 1] = -data[2 * bin + 1];
+        }
+    }
+}
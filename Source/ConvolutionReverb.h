@@ -0,0 +1,172 @@
+#pragma once
+
+#include "JuceHeader.h"
+
+namespace EchoSphere
+{
+    // Zero-latency convolution reverb using a non-uniformly partitioned impulse response.
+    //
+    // The impulse response is split into three tiers:
+    //   1. Direct head:  h[0, P)        - time-domain FIR on the audio thread
+    //   2. FFT head:     h[P, 2Q)       - uniform P-sized partitions on the audio thread
+    //   3. FFT tail:     h[2Q, end)     - uniform Q-sized partitions on a background worker
+    //
+    // Because the FFT tail only starts at 2Q, every tail block has a full Q samples
+    // between its input being complete and its output being needed. That is the
+    // worker's deadline; if it is missed the tail contribution for that block is
+    // dropped instead of stalling the audio thread.
+    class ConvolutionReverb
+    {
+    public:
+        ConvolutionReverb();
+        ~ConvolutionReverb();
+
+        // Partition sizes (in samples) for the audio-thread head and the background tail
+        static constexpr int headPartitionSize = 128;
+        static constexpr int tailPartitionSize = 2048;
+
+        // Longest impulse response accepted, in seconds
+        static constexpr double maxImpulseLengthSeconds = 10.0;
+
+        // Set up FFTs, partition the current impulse response and start the tail worker.
+        // Must not be called from the audio thread.
+        void prepare(double sampleRate, int numChannels);
+
+        // Stop the tail worker and free processing state
+        void release();
+
+        // Load a new impulse response. Partitioning and FFTs happen on the calling thread;
+        // the audio thread picks the result up at its next tail boundary.
+        // Must not be called from the audio thread.
+        void loadImpulseResponse(juce::AudioBuffer<float>&& impulse, double impulseSampleRate);
+        bool loadImpulseResponse(const juce::File& file);
+
+        // Set the wet/dry mix (0.0 - 100.0)
+        void setMix(float wetDryMix);
+        
+        // When rendering offline the audio thread waits for the tail worker at each
+        // deadline instead of dropping late tail blocks
+        void setNonRealtime(bool isNonRealtime) { nonRealtime = isNonRealtime; }
+
+        // Process all channels of a block in place
+        void processBlock(juce::AudioBuffer<float>& buffer);
+
+        // Clear all convolution history
+        void reset();
+
+        // Length of the active impulse response in seconds
+        double getImpulseLengthSeconds() const { return impulseLengthSeconds.load(); }
+
+        // Number of tail blocks whose background deadline was missed since prepare()
+        int getNumMissedTailDeadlines() const { return missedTailDeadlines.load(); }
+
+    private:
+        static constexpr int headFFTOrder = 8;
+        static constexpr int tailFFTOrder = 12;
+        static constexpr int headFFTSize = 1 << headFFTOrder;
+        static constexpr int tailFFTSize = 1 << tailFFTOrder;
+        static constexpr int numHeadPartitions = (2 * tailPartitionSize) / headPartitionSize - 1;
+        static constexpr int headSpectrumSize = headFFTSize + 2;   // (N/2 + 1) interleaved complex bins
+        static constexpr int tailSpectrumSize = tailFFTSize + 2;
+        static constexpr int maxChannels = 2;
+        static constexpr int numTailSlots = 4;
+
+        static_assert(headFFTSize == 2 * headPartitionSize, "Head FFT must hold two head partitions");
+        static_assert(tailFFTSize == 2 * tailPartitionSize, "Tail FFT must hold two tail partitions");
+        static_assert(tailPartitionSize % headPartitionSize == 0, "Tail boundaries must align with head boundaries");
+
+        // Partitioned, frequency-domain impulse response. Built off the audio thread.
+        struct Kernel
+        {
+            int serial = 0;
+            int numChannels = 0;
+            int lengthInSamples = 0;
+            int numTailPartitions = 0;
+            std::vector<float> direct[maxChannels];        // P taps
+            std::vector<float> headSpectra[maxChannels];   // numHeadPartitions * headSpectrumSize
+            std::vector<float> tailSpectra[maxChannels];   // numTailPartitions * tailSpectrumSize
+            std::atomic<int> retiredAfterJob { -1 };       // -1 while still in use
+        };
+
+        // One Q-sized block of input handed from the audio thread to the tail worker
+        struct TailSlot
+        {
+            const Kernel* kernel = nullptr;
+            bool clearHistory = false;
+            std::vector<float> input[maxChannels];
+            std::vector<float> output[maxChannels];
+        };
+
+        class TailWorker : public juce::Thread
+        {
+        public:
+            explicit TailWorker(ConvolutionReverb& ownerRef);
+            void run() override;
+
+        private:
+            void processJob(TailSlot& slot);
+
+            ConvolutionReverb& owner;
+            juce::dsp::FFT fft;
+            int currentKernelSerial = 0;
+            int fdlPosition = 0;
+            std::vector<float> previousInput[maxChannels];
+            std::vector<float> fdl[maxChannels];           // numTailPartitions * tailSpectrumSize
+            std::vector<float> workBuffer;
+            std::vector<float> accumulator;
+        };
+
+        std::unique_ptr<Kernel> buildKernel(const juce::AudioBuffer<float>& impulse, double impulseSampleRate) const;
+        static juce::AudioBuffer<float> createDefaultImpulse(double sampleRate);
+        void stopTailWorker();
+        void installKernel(std::unique_ptr<Kernel> kernel);
+        void deleteRetiredKernels();
+        void processHeadPartition(int channel);
+        void onTailBoundary();
+
+        static void fillSymmetricSpectrum(float* data, int fftSize);
+
+        // Loader-side state (message / loader threads only)
+        juce::CriticalSection loaderLock;
+        juce::AudioBuffer<float> sourceImpulse;
+        double sourceImpulseSampleRate = 0.0;
+        juce::OwnedArray<Kernel> kernels;
+        int nextKernelSerial = 1;
+
+        // Handover between loader and audio thread
+        std::atomic<Kernel*> pendingKernel { nullptr };
+        std::atomic<Kernel*> activeKernel { nullptr };
+
+        // Audio-thread state
+        juce::dsp::FFT headFFT;
+        double currentSampleRate;
+        int numActiveChannels;
+        int headFill;
+        int tailFill;
+        float mix;
+        std::vector<float> headInput[maxChannels];      // previous + current P-block (overlap-save)
+        std::vector<float> headOutput[maxChannels];     // FFT head contribution for the current P-block
+        std::vector<float> headFDL[maxChannels];        // numHeadPartitions * headSpectrumSize
+        std::vector<float> tailInput[maxChannels];      // current Q-block
+        std::vector<float> tailPlayback[maxChannels];   // tail contribution for the current Q-block
+        std::vector<float> headWork;
+        std::vector<float> headAccumulator;
+        std::vector<float> wetScratch;                  // wet output for up to one P-block
+        int headFDLPosition;
+        int lastPostedJob;
+        bool historyClearPending;
+        bool bypassed;
+        bool nonRealtime;
+
+        // Tail job handover (single producer / single consumer)
+        TailSlot tailSlots[numTailSlots];
+        std::atomic<int> postedJobs { 0 };
+        std::atomic<int> completedJobs { 0 };
+        std::atomic<int> missedTailDeadlines { 0 };
+        std::atomic<double> impulseLengthSeconds { 0.0 };
+        juce::WaitableEvent jobCompleted;
+        std::unique_ptr<TailWorker> tailWorker;
+
+        JUCE_DECLARE_NON_COPYABLE(ConvolutionReverb)
+    };
+}
@@ -0,0 +1,135 @@
+#include "DSPKernels.h"
+#include "JuceHeader.h"
+
+// Baseline build of the kernels, using the target's default instruction set
+#define ECHOSPHERE_KERNEL_VARIANT baseline
+#define ECHOSPHERE_KERNEL_VARIANT_ISA ISA::baseline
+#include "DSPKernelsImpl.h"
+
+namespace EchoSphere
+{
+    namespace Kernels
+    {
+        namespace
+        {
+            std::atomic<const Table*> activeTable { nullptr };
+
+            const Table* getTableFor(ISA isa) noexcept
+            {
+                switch (isa)
+                {
+                   #if ECHOSPHERE_KERNELS_X86
+                    case ISA::avx2:   return &getAVX2Table();
+                    case ISA::avx512: return &getAVX512Table();
+                   #endif
+                    case ISA::baseline:
+                    default:          return &getBaselineTable();
+                }
+            }
+
+            ISA findBestISA()
+            {
+                // Environment override, mainly for benchmarking on a fleet machine
+                const auto forced = juce::SystemStats::getEnvironmentVariable("ECHOSPHERE_KERNEL_ISA", {}).trim();
+
+                for (int i = 0; i < static_cast<int>(ISA::numISAs); ++i)
+                {
+                    const auto isa = static_cast<ISA>(i);
+
+                    if (forced.equalsIgnoreCase(getName(isa)) && isSupported(isa))
+                        return isa;
+                }
+
+                if (isSupported(ISA::avx512))
+                    return ISA::avx512;
+
+                if (isSupported(ISA::avx2))
+                    return ISA::avx2;
+
+                return ISA::baseline;
+            }
+        }
+
+        int getFixedBlockSizeIndex(int numSamples) noexcept
+        {
+            for (int i = 0; i < numFixedBlockSizes; ++i)
+                if (fixedBlockSizes[i] == numSamples)
+                    return i;
+
+            return -1;
+        }
+
+        const Table& getBaselineTable() noexcept
+        {
+            return baseline::table;
+        }
+
+        const Table& get() noexcept
+        {
+            auto* table = activeTable.load(std::memory_order_acquire);
+
+            if (table == nullptr)
+            {
+                table = getTableFor(findBestISA());
+                activeTable.store(table, std::memory_order_release);
+            }
+
+            return *table;
+        }
+
+        bool isSupported(ISA isa)
+        {
+            switch (isa)
+            {
+                case ISA::baseline:
+                    return true;
+
+               #if ECHOSPHERE_KERNELS_X86
+                case ISA::avx2:
+                    return juce::SystemStats::hasAVX2() && juce::SystemStats::hasFMA3();
+
+                case ISA::avx512:
+                    return juce::SystemStats::hasAVX512F() && juce::SystemStats::hasAVX512DQ()
+                        && juce::SystemStats::hasAVX512VL() && juce::SystemStats::hasFMA3();
+               #endif
+
+                case ISA::numISAs:
+                default:
+                    return false;
+            }
+        }
+
+        bool force(ISA isa)
+        {
+            if (!isSupported(isa))
+                return false;
+
+            activeTable.store(getTableFor(isa), std::memory_order_release);
+            return true;
+        }
+
+        void selectBest()
+        {
+            activeTable.store(getTableFor(findBestISA()), std::memory_order_release);
+        }
+
+        ISA getActiveISA() noexcept
+        {
+            return get().isa;
+        }
+
+        const char* getName(ISA isa) noexcept
+        {
+            switch (isa)
+            {
+                case ISA::baseline: return "baseline";
+                case ISA::avx2:     return "avx2";
+                case ISA::avx512:   return "avx512";
+                case ISA::numISAs:
+                default:            break;
+            }
+
+            return "unknown";
+        }
+    }
+}
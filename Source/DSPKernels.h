@@ -0,0 +1,131 @@
+#pragma once
+
+// Hot DSP kernels, compiled once per instruction set and selected at runtime.
+//
+// This header deliberately includes nothing: it is shared by the per-ISA
+// translation units, which must not instantiate any inline or template code
+// that could be merged with a baseline copy at link time.
+
+#if defined (__x86_64__) || defined (_M_X64) || defined (__i386__) || defined (_M_IX86)
+ #ifndef ECHOSPHERE_KERNELS_X86
+  #define ECHOSPHERE_KERNELS_X86 1
+ #endif
+#else
+ #undef ECHOSPHERE_KERNELS_X86
+ #define ECHOSPHERE_KERNELS_X86 0
+#endif
+
+namespace EchoSphere
+{
+    namespace Kernels
+    {
+        // Instruction set variants. Baseline is whatever the target compiles for by default
+        // (SSE2 on x86-64, NEON on arm64).
+        enum class ISA
+        {
+            baseline = 0,
+            avx2,
+            avx512,
+            numISAs
+        };
+
+        // Common host block sizes. Each gets delay kernels with a compile-time length, so
+        // the compiler can unroll and vectorise them with no remainder loop.
+        inline constexpr int fixedBlockSizes[] = { 32, 64, 128, 256, 512 };
+        inline constexpr int numFixedBlockSizes = static_cast<int>(sizeof(fixedBlockSizes) / sizeof(fixedBlockSizes[0]));
+
+        // Grain slots in a pitch shifter. The overlap-add kernel always runs all of them,
+        // one vector lane per grain, so its cost doesn't depend on how many are sounding.
+        inline constexpr int maxGrains = 4;
+
+        // Feedback delay over one contiguous block. older[i] and older[i + 1] are the two
+        // taps either side of output i; write receives io + delayed * feedback before io
+        // is replaced with the dry/wet mix. The read and write windows must not overlap.
+        using DelayBlockFunction = void (*)(float* io, float* write, const float* older, float fraction,
+                                            float feedback, float dryGain, float wetGain, int numSamples);
+
+        // Mid/side version: encode L/R, run both feedback delays, decode into the mix
+        using MidSideDelayBlockFunction = void (*)(float* left, float* right, float* midWrite, float* sideWrite,
+                                                   const float* midOlder, const float* sideOlder,
+                                                   float midFraction, float sideFraction, float midFeedback, float sideFeedback,
+                                                   float dryGain, float wetGain, int numSamples);
+
+        struct Table
+        {
+            ISA isa;
+
+            // acc[k] += a[k] * b[k] for numBins interleaved complex values
+            void (*complexMultiplyAccumulate)(float* acc, const float* a, const float* b, int numBins);
+
+            // Returns sum(a[i] * b[i])
+            float (*dotProduct)(const float* a, const float* b, int numSamples);
+
+            // io[i] = io[i] * dryGain + wet[i] * wetGain
+            void (*mixDryWet)(float* io, const float* wet, float dryGain, float wetGain, int numSamples);
+
+            // Any block length
+            DelayBlockFunction delayBlock;
+            MidSideDelayBlockFunction midSideDelayBlock;
+
+            // One per entry of fixedBlockSizes; numSamples must equal that size
+            DelayBlockFunction delayBlockFixed[numFixedBlockSizes];
+            MidSideDelayBlockFunction midSideDelayBlockFixed[numFixedBlockSizes];
+
+            // Linearly interpolated read: output[i] = older[i + 1] + fraction * (older[i] - older[i + 1])
+            void (*interpolateBlock)(float* output, const float* older, float fraction, int numSamples);
+
+            // Windowed grain overlap-add. Grain g reads source at sourceOffset[g] + rate[g] * i
+            // (linearly interpolated) and is weighted by window[windowOffset[g] + i]
+            void (*grainOverlapAdd)(float* output, const float* source, const float* window, const int* windowOffset,
+                                    const float* sourceOffset, const float* rate, int numSamples);
+
+            // delayBlock with shifted[i] blended into the feedback only, by shimmer (0 - 1)
+            void (*shimmerDelayBlock)(float* io, float* write, const float* older, const float* shifted, float fraction,
+                                      float shimmer, float feedback, float dryGain, float wetGain, int numSamples);
+
+            // io[i] = io[i] * dryGain + (from[i] + fadeIn[i] * (to[i] - from[i])) * wetGain
+            void (*crossfadeMixBlock)(float* io, const float* from, const float* to, const float* fadeIn,
+                                      float dryGain, float wetGain, int numSamples);
+
+            // Feedback delay reading backwards: output i is oldest[numSamples - 1 - i], so oldest
+            // is the low end of the window and its last sample plays first
+            void (*reverseDelayBlock)(float* io, float* write, const float* oldest, float feedback,
+                                      float dryGain, float wetGain, int numSamples);
+
+            // reverseDelayBlock fading from the fadingOldest window to the oldest one over fadeIn
+            void (*reverseCrossfadeDelayBlock)(float* io, float* write, const float* oldest, const float* fadingOldest,
+                                               const float* fadeIn, float feedback, float dryGain, float wetGain, int numSamples);
+
+            // Two interpolated reads (same tap layout as interpolateBlock) weighted by fadeOut and fadeIn
+            void (*crossfadeTapBlock)(float* output, const float* olderFrom, const float* olderTo, float fractionFrom,
+                                      float fractionTo, const float* fadeOut, const float* fadeIn, int numSamples);
+        };
+
+        // Index into the fixed-size kernel arrays, or -1 if numSamples has no specialisation
+        int getFixedBlockSizeIndex(int numSamples) noexcept;
+
+        // The active kernel table. Chosen from CPUID on first use unless forced.
+        const Table& get() noexcept;
+
+        // Whether this binary contains the variant and the CPU can run it
+        bool isSupported(ISA isa);
+
+        // Force a specific variant for testing and benchmarking. Returns false (and leaves
+        // the current selection alone) if the variant is unsupported.
+        bool force(ISA isa);
+
+        // Go back to the best variant for this CPU
+        void selectBest();
+
+        ISA getActiveISA() noexcept;
+        const char* getName(ISA isa) noexcept;
+
+        // Per-variant tables, each defined in its own translation unit
+        const Table& getBaselineTable() noexcept;
+
+       #if ECHOSPHERE_KERNELS_X86
+        const Table& getAVX2Table() noexcept;
+        const Table& getAVX512Table() noexcept;
+       #endif
+    }
+}
@@ -0,0 +1,16 @@
+// AVX2 + FMA build of the DSP kernels (compiled with -mavx2 -mfma or /arch:AVX2)
+
+#include "DSPKernels.h"
+
+#if ECHOSPHERE_KERNELS_X86
+
+#define ECHOSPHERE_KERNEL_VARIANT avx2
+#define ECHOSPHERE_KERNEL_VARIANT_ISA ISA::avx2
+#include "DSPKernelsImpl.h"
+
+const EchoSphere::Kernels::Table& EchoSphere::Kernels::getAVX2Table() noexcept
+{
+    return avx2::table;
+}
+
+#endif
@@ -0,0 +1,16 @@
+// AVX-512 build of the DSP kernels (compiled with -mavx512f -mavx512dq -mavx512vl -mfma or /arch:AVX512)
+
+#include "DSPKernels.h"
+
+#if ECHOSPHERE_KERNELS_X86
+
+#define ECHOSPHERE_KERNEL_VARIANT avx512
+#define ECHOSPHERE_KERNEL_VARIANT_ISA ISA::avx512
+#include "DSPKernelsImpl.h"
+
+const EchoSphere::Kernels::Table& EchoSphere::Kernels::getAVX512Table() noexcept
+{
+    return avx512::table;
+}
+
+#endif
@@ -0,0 +1,217 @@
+// Kernel bodies shared by every ISA variant. No include guard: this file is
+// included once per variant translation unit, inside that variant's namespace.
+// Define ECHOSPHERE_KERNEL_VARIANT (namespace name) and ECHOSPHERE_KERNEL_VARIANT_ISA
+// (a Kernels::ISA value) before including it.
+//
+// Everything here has internal linkage and uses no library code, so the
+// compiler can't share an instantiation between variants.
+
+#if ! defined (ECHOSPHERE_KERNEL_VARIANT) || ! defined (ECHOSPHERE_KERNEL_VARIANT_ISA)
+ #error "Define ECHOSPHERE_KERNEL_VARIANT and ECHOSPHERE_KERNEL_VARIANT_ISA before including DSPKernelsImpl.h"
+#endif
+
+namespace EchoSphere
+{
+    namespace Kernels
+    {
+        namespace ECHOSPHERE_KERNEL_VARIANT
+        {
+            // Independent accumulators let the compiler vectorise reductions without fast-math
+            static constexpr int numAccumulators = 16;
+
+            static void complexMultiplyAccumulate(float* __restrict acc, const float* __restrict a,
+                                                  const float* __restrict b, int numBins)
+            {
+                for (int bin = 0; bin < numBins; ++bin)
+                {
+                    const float ar = a[2 * bin], ai = a[2 * bin + 1];
+                    const float br = b[2 * bin], bi = b[2 * bin + 1];
+                    acc[2 * bin]     += ar * br - ai * bi;
+                    acc[2 * bin + 1] += ar * bi + ai * br;
+                }
+            }
+
+            static float dotProduct(const float* __restrict a, const float* __restrict b, int numSamples)
+            {
+                float partial[numAccumulators] = {};
+                int i = 0;
+
+                for (; i + numAccumulators <= numSamples; i += numAccumulators)
+                    for (int lane = 0; lane < numAccumulators; ++lane)
+                        partial[lane] += a[i + lane] * b[i + lane];
+
+                float sum = 0.0f;
+
+                for (int lane = 0; lane < numAccumulators; ++lane)
+                    sum += partial[lane];
+
+                for (; i < numSamples; ++i)
+                    sum += a[i] * b[i];
+
+                return sum;
+            }
+
+            static void mixDryWet(float* __restrict io, const float* __restrict wet, float dryGain, float wetGain, int numSamples)
+            {
+                for (int i = 0; i < numSamples; ++i)
+                    io[i] = io[i] * dryGain + wet[i] * wetGain;
+            }
+
+            // fixedLength > 0 gives the loop a compile-time trip count; 0 is the generic version
+            template <int fixedLength>
+            static void delayBlock(float* __restrict io, float* __restrict write, const float* __restrict older,
+                                   float fraction, float feedback, float dryGain, float wetGain, int numSamples)
+            {
+                const int length = fixedLength > 0 ? fixedLength : numSamples;
+
+                for (int i = 0; i < length; ++i)
+                {
+                    const float input = io[i];
+                    const float delayed = older[i + 1] + fraction * (older[i] - older[i + 1]);
+                    write[i] = input + delayed * feedback;
+                    io[i] = input * dryGain + delayed * wetGain;
+                }
+            }
+
+            template <int fixedLength>
+            static void midSideDelayBlock(float* __restrict left, float* __restrict right,
+                                          float* __restrict midWrite, float* __restrict sideWrite,
+                                          const float* __restrict midOlder, const float* __restrict sideOlder,
+                                          float midFraction, float sideFraction, float midFeedback, float sideFeedback,
+                                          float dryGain, float wetGain, int numSamples)
+            {
+                const int length = fixedLength > 0 ? fixedLength : numSamples;
+
+                for (int i = 0; i < length; ++i)
+                {
+                    const float l = left[i];
+                    const float r = right[i];
+
+                    // Encode: [M S] = 0.5 * [1 1; 1 -1] [L R]
+                    const float mid = 0.5f * (l + r);
+                    const float side = 0.5f * (l - r);
+
+                    const float midDelayed = midOlder[i + 1] + midFraction * (midOlder[i] - midOlder[i + 1]);
+                    const float sideDelayed = sideOlder[i + 1] + sideFraction * (sideOlder[i] - sideOlder[i + 1]);
+
+                    midWrite[i] = mid + midDelayed * midFeedback;
+                    sideWrite[i] = side + sideDelayed * sideFeedback;
+
+                    // Decode: [L R] = [1 1; 1 -1] [M S], folded into the dry/wet mix
+                    left[i] = l * dryGain + (midDelayed + sideDelayed) * wetGain;
+                    right[i] = r * dryGain + (midDelayed - sideDelayed) * wetGain;
+                }
+            }
+
+            static void interpolateBlock(float* __restrict output, const float* __restrict older, float fraction, int numSamples)
+            {
+                for (int i = 0; i < numSamples; ++i)
+                    output[i] = older[i + 1] + fraction * (older[i] - older[i + 1]);
+            }
+
+            static void grainOverlapAdd(float* __restrict output, const float* __restrict source, const float* __restrict window,
+                                        const int* __restrict windowOffset, const float* __restrict sourceOffset,
+                                        const float* __restrict rate, int numSamples)
+            {
+                for (int i = 0; i < numSamples; ++i)
+                {
+                    // Fixed trip count with no dependency between slots: one lane per grain
+                    float grain[maxGrains];
+
+                    for (int g = 0; g < maxGrains; ++g)
+                    {
+                        const float position = sourceOffset[g] + rate[g] * static_cast<float>(i);
+                        const int index = static_cast<int>(position);
+                        const float fraction = position - static_cast<float>(index);
+                        grain[g] = window[windowOffset[g] + i] * (source[index] + fraction * (source[index + 1] - source[index]));
+                    }
+
+                    output[i] = (grain[0] + grain[1]) + (grain[2] + grain[3]);
+                }
+            }
+
+            static void shimmerDelayBlock(float* __restrict io, float* __restrict write, const float* __restrict older,
+                                          const float* __restrict shifted, float fraction, float shimmer, float feedback,
+                                          float dryGain, float wetGain, int numSamples)
+            {
+                for (int i = 0; i < numSamples; ++i)
+                {
+                    const float input = io[i];
+                    const float delayed = older[i + 1] + fraction * (older[i] - older[i + 1]);
+                    const float fedBack = delayed + shimmer * (shifted[i] - delayed);
+                    write[i] = input + fedBack * feedback;
+                    io[i] = input * dryGain + delayed * wetGain;
+                }
+            }
+
+            static void crossfadeMixBlock(float* __restrict io, const float* __restrict from, const float* __restrict to,
+                                          const float* __restrict fadeIn, float dryGain, float wetGain, int numSamples)
+            {
+                for (int i = 0; i < numSamples; ++i)
+                    io[i] = io[i] * dryGain + (from[i] + fadeIn[i] * (to[i] - from[i])) * wetGain;
+            }
+
+            static void reverseDelayBlock(float* __restrict io, float* __restrict write, const float* __restrict oldest,
+                                          float feedback, float dryGain, float wetGain, int numSamples)
+            {
+                for (int i = 0; i < numSamples; ++i)
+                {
+                    const float input = io[i];
+                    const float reversed = oldest[numSamples - 1 - i];
+                    write[i] = input + reversed * feedback;
+                    io[i] = input * dryGain + reversed * wetGain;
+                }
+            }
+
+            static void reverseCrossfadeDelayBlock(float* __restrict io, float* __restrict write, const float* __restrict oldest,
+                                                   const float* __restrict fadingOldest, const float* __restrict fadeIn,
+                                                   float feedback, float dryGain, float wetGain, int numSamples)
+            {
+                for (int i = 0; i < numSamples; ++i)
+                {
+                    const float input = io[i];
+                    const float fading = fadingOldest[numSamples - 1 - i];
+                    const float reversed = fading + fadeIn[i] * (oldest[numSamples - 1 - i] - fading);
+                    write[i] = input + reversed * feedback;
+                    io[i] = input * dryGain + reversed * wetGain;
+                }
+            }
+
+            static void crossfadeTapBlock(float* __restrict output, const float* __restrict olderFrom, const float* __restrict olderTo,
+                                          float fractionFrom, float fractionTo, const float* __restrict fadeOut,
+                                          const float* __restrict fadeIn, int numSamples)
+            {
+                for (int i = 0; i < numSamples; ++i)
+                {
+                    const float from = olderFrom[i + 1] + fractionFrom * (olderFrom[i] - olderFrom[i + 1]);
+                    const float to = olderTo[i + 1] + fractionTo * (olderTo[i] - olderTo[i + 1]);
+                    output[i] = from * fadeOut[i] + to * fadeIn[i];
+                }
+            }
+
+            static const Table table {
+                ECHOSPHERE_KERNEL_VARIANT_ISA,
+                complexMultiplyAccumulate,
+                dotProduct,
+                mixDryWet,
+                delayBlock<0>,
+                midSideDelayBlock<0>,
+                { delayBlock<32>, delayBlock<64>, delayBlock<128>, delayBlock<256>, delayBlock<512> },
+                { midSideDelayBlock<32>, midSideDelayBlock<64>, midSideDelayBlock<128>, midSideDelayBlock<256>, midSideDelayBlock<512> },
+                interpolateBlock,
+                grainOverlapAdd,
+                shimmerDelayBlock,
+                crossfadeMixBlock,
+                reverseDelayBlock,
+                reverseCrossfadeDelayBlock,
+                crossfadeTapBlock
+            };
+
+            static_assert(numFixedBlockSizes == 5 && fixedBlockSizes[0] == 32 && fixedBlockSizes[1] == 64
+                              && fixedBlockSizes[2] == 128 && fixedBlockSizes[3] == 256 && fixedBlockSizes[4] == 512,
+                          "The fixed-size kernel lists above must match Kernels::fixedBlockSizes");
+
+            static_assert(maxGrains == 4, "grainOverlapAdd's final sum must match Kernels::maxGrains");
+        }
+    }
+}
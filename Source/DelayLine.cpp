@@ -8,48 +8,226 @@ namespace EchoSphere
         , currentSampleRate(44100.0)
         , delayTimeInSamples(0.0f)
         , lastSample(0.0f)
+        , fixedBlockIndex(-1)
+        , shimmer(0.0f)
+        , loopFadeLength(1)
+        , frozen(false)
+        , frozenLength(1)
+        , frozenPosition(0)
+        , reversed(false)
+        , reverseLength(1)
+        , previousReverseLength(1)
+        , reversePosition(0)
+        , activeMode(LoopMode::normal)
+        , fadingMode(LoopMode::normal)
+        , modeFadePosition(1)
+        , fadingDelay(1.0f)
+        , fadingFromDelay(1.0f)
+        , fadingRetargetPosition(1)
+        , fadingHead(0)
+        , fadingPreviousHead(0)
+        , fadingPosition(0)
+        , retargetLength(1)
+        , retargetPosition(1)
+        , retargetFromInSamples(0.0f)
+        , hasDelayTime(false)
+        , hasPendingDelayTime(false)
+        , pendingDelayInSamples(0.0f)
+        , samplesUntilScheduled(-1)
+        , scheduledDelayInSamples(0.0f)
+        , wetPathDivisor(1)
+        , maxBlockSize(512)
     {
-        // Initialize the delay line with default parameters and proper ProcessSpec
-        juce::dsp::ProcessSpec spec;
-        spec.sampleRate = currentSampleRate;
-        spec.maximumBlockSize = 512; // Reasonable default
-        spec.numChannels = 1;        // We process one channel at a time
-        
-        // First prepare with proper spec
-        delayLine.prepare(spec);
-        delayLine.setMaximumDelayInSamples(static_cast<int>(currentSampleRate * 5.0)); // 5 seconds at 44.1kHz
-        delayLine.reset();
+        // Nothing is allocated until prepare; until then every process call passes through
     }
 
     DelayLine::~DelayLine()
     {
     }
 
-    void DelayLine::prepare(double sampleRate, int maxDelayTimeMs)
+    void DelayLine::prepare(double sampleRate, int samplesPerBlock, int newWetPathDivisor, int maxDelayTimeMs)
     {
         currentSampleRate = sampleRate;
+        maxBlockSize = juce::jmax(1, samplesPerBlock);
+        
+        // The feedback loop runs at sampleRate / wetPathDivisor
+        resampler.prepare(sampleRate, newWetPathDivisor, maxBlockSize);
+        wetPathDivisor = resampler.getDivisor();
+        
+        const int loopBlockSize = wetPathDivisor > 1 ? resampler.getMaxLowRateBlockSize() : maxBlockSize;
+        lowRateInput.assign(static_cast<size_t>(loopBlockSize), 0.0f);
+        lowRateWet.assign(static_cast<size_t>(loopBlockSize), 0.0f);
+        hostRateWet.assign(static_cast<size_t>(maxBlockSize), 0.0f);
+        shiftedWet.assign(static_cast<size_t>(loopBlockSize), 0.0f);
+        
+        // Grain windows are built here, at the rate of the buffer the grains read
+        pitchShifter.prepare(sampleRate / wetPathDivisor, loopBlockSize);
+        
+        // 5 ms seam crossfade for freeze and reverse
+        loopFadeLength = juce::jmax(1, juce::roundToInt(0.005 * sampleRate / wetPathDivisor));
+        loopFade.resize(static_cast<size_t>(loopFadeLength));
+        
+        for (int j = 0; j < loopFadeLength; ++j)
+            loopFade[static_cast<size_t>(j)] = static_cast<float>(0.5 - 0.5 * std::cos(juce::MathConstants<double>::pi * (j + 0.5) / loopFadeLength));
+            
+        modeFadeFrom.assign(static_cast<size_t>(loopBlockSize), 0.0f);
+        modeFadeTo.assign(static_cast<size_t>(loopBlockSize), 0.0f);
+        modeFadeScratch.assign(static_cast<size_t>(loopBlockSize), 0.0f);
+        
+        // Equal-power read-head crossfade for delay time changes
+        retargetLength = juce::jmax(1, juce::roundToInt(retargetFadeMs * 0.001 * sampleRate / wetPathDivisor));
+        retargetFadeIn.resize(static_cast<size_t>(retargetLength));
+        retargetFadeOut.resize(static_cast<size_t>(retargetLength));
+        
+        for (int j = 0; j < retargetLength; ++j)
+        {
+            const double angle = juce::MathConstants<double>::halfPi * (j + 0.5) / retargetLength;
+            retargetFadeIn[static_cast<size_t>(j)] = static_cast<float>(std::sin(angle));
+            retargetFadeOut[static_cast<size_t>(j)] = static_cast<float>(std::cos(angle));
+        }
         
-        // Calculate maximum delay in samples
-        const int maxDelaySamples = static_cast<int>((maxDelayTimeMs / 1000.0) * sampleRate) + 1;
+        // One leading sample so the kernels' older[i] read stays inside the buffer
+        retargetTap.assign(static_cast<size_t>(loopBlockSize + 1), 0.0f);
+        
+        // Calculate maximum delay in samples (at the loop's rate)
+        const int maxDelaySamples = static_cast<int>((maxDelayTimeMs / 1000.0) * sampleRate) / wetPathDivisor + 1;
         
         // Properly prepare the delay line with ProcessSpec
         juce::dsp::ProcessSpec spec;
-        spec.sampleRate = sampleRate;
-        spec.maximumBlockSize = 512; // Set a reasonable default block size
+        spec.sampleRate = sampleRate / wetPathDivisor;
+        spec.maximumBlockSize = static_cast<juce::uint32>(loopBlockSize);
         spec.numChannels = 1;        // We process one channel at a time
         
         // Prepare delay line with proper spec
         delayLine.prepare(spec);
         delayLine.setMaximumDelayInSamples(maxDelaySamples);
         
+        // Use the unrolled kernels if the loop's block size is one we have them for
+        fixedBlockIndex = samplesPerBlock % wetPathDivisor == 0
+                              ? Kernels::getFixedBlockSizeIndex(samplesPerBlock / wetPathDivisor)
+                              : -1;
+        
+        // Pick the kernel ISA variant now rather than on the first audio callback
+        juce::ignoreUnused(Kernels::get());
+        
         // Reset internal state
         reset();
+        
+        // Loop lengths from before are meaningless in the new buffer
+        frozen = false;
+        reversed = false;
+        activeMode = LoopMode::normal;
+        
+        // The first delay time after prepare is taken as is, with nothing to fade from
+        hasDelayTime = false;
     }
 
     void DelayLine::setDelayTime(float delayTimeMs)
     {
         // Convert milliseconds to samples
-        delayTimeInSamples = (delayTimeMs / 1000.0f) * static_cast<float>(currentSampleRate);
+        samplesUntilScheduled = -1;
+        startRetarget((delayTimeMs / 1000.0f) * static_cast<float>(currentSampleRate));
+    }
+
+    void DelayLine::scheduleDelayTime(float delayTimeMs, int sampleOffset)
+    {
+        // Nothing to wait for before the first delay time
+        if (sampleOffset <= 0 || !hasDelayTime)
+        {
+            setDelayTime(delayTimeMs);
+            return;
+        }
+        
+        // Counted at the buffer's rate, since that's where chunks are split
+        scheduledDelayInSamples = (delayTimeMs / 1000.0f) * static_cast<float>(currentSampleRate);
+        samplesUntilScheduled = juce::jmax(1, sampleOffset / wetPathDivisor);
+    }
+
+    void DelayLine::startRetarget(float newDelayInSamples)
+    {
+        if (!hasDelayTime)
+        {
+            delayTimeInSamples = newDelayInSamples;
+            hasDelayTime = true;
+            return;
+        }
+        
+        // Back at the current target: drop whatever was queued
+        if (std::abs(newDelayInSamples - delayTimeInSamples) < 1.0e-3f)
+        {
+            hasPendingDelayTime = false;
+            return;
+        }
+        
+        if (isRetargeting())
+        {
+            pendingDelayInSamples = newDelayInSamples;
+            hasPendingDelayTime = true;
+            return;
+        }
+        
+        retargetFromInSamples = delayTimeInSamples;
+        delayTimeInSamples = newDelayInSamples;
+        retargetPosition = 0;
+    }
+
+    int DelayLine::limitChunkForRetarget(int numSamples) const
+    {
+        if (samplesUntilScheduled > 0)
+            numSamples = juce::jmin(numSamples, samplesUntilScheduled);
+            
+        if (isRetargeting())
+            numSamples = juce::jmin(numSamples, retargetLength - retargetPosition,
+                                    getMaximumChunkSize(getValidDelayTime(retargetFromInSamples)));
+            
+        return numSamples;
+    }
+
+    DelayLine::LoopTap DelayLine::getLoopTap(int numSamples)
+    {
+        const float delay = getValidDelayTime();
+        const int delayInt = static_cast<int>(delay);
+        const float* older = delayLine.getReadPointer(delayInt + 1);
+        const float fraction = delay - static_cast<float>(delayInt);
+        
+        if (!isRetargeting())
+            return { older, fraction };
+            
+        const float fromDelay = getValidDelayTime(retargetFromInSamples);
+        const int fromDelayInt = static_cast<int>(fromDelay);
+        
+        Kernels::get().crossfadeTapBlock(retargetTap.data() + 1, delayLine.getReadPointer(fromDelayInt + 1), older,
+                                         fromDelay - static_cast<float>(fromDelayInt), fraction,
+                                         retargetFadeOut.data() + retargetPosition, retargetFadeIn.data() + retargetPosition,
+                                         numSamples);
+        
+        // older[i + 1] is output i, at a fraction of zero
+        return { retargetTap.data(), 0.0f };
+    }
+
+    void DelayLine::advanceRetarget(int numSamples)
+    {
+        if (isRetargeting())
+        {
+            retargetPosition += numSamples;
+            
+            if (!isRetargeting() && hasPendingDelayTime)
+            {
+                hasPendingDelayTime = false;
+                startRetarget(pendingDelayInSamples);
+            }
+        }
+        
+        if (samplesUntilScheduled > 0)
+        {
+            samplesUntilScheduled -= numSamples;
+            
+            if (samplesUntilScheduled == 0)
+            {
+                samplesUntilScheduled = -1;
+                startRetarget(scheduledDelayInSamples);
+            }
+        }
     }
 
     void DelayLine::setFeedback(float feedbackAmount)
@@ -64,25 +242,99 @@ namespace EchoSphere
         mix = juce::jlimit(0.0f, 1.0f, wetDryMix / 100.0f);
     }
 
+    void DelayLine::setPitchShift(float semitones)
+    {
+        pitchShifter.setSemitones(juce::jlimit(-24.0f, 24.0f, semitones));
+    }
+
+    void DelayLine::setShimmer(float shimmerAmount)
+    {
+        const float newShimmer = juce::jlimit(0.0f, 1.0f, shimmerAmount / 100.0f);
+        
+        // Grains left over from the last time the stage ran are stale
+        if (shimmer == 0.0f && newShimmer > 0.0f)
+            pitchShifter.reset();
+            
+        shimmer = newShimmer;
+    }
+
+    void DelayLine::setFreeze(bool shouldFreeze)
+    {
+        // Picked up by updateLoopMode at the start of the next block
+        frozen = shouldFreeze;
+    }
+
+    void DelayLine::setReverse(bool shouldReverse)
+    {
+        reversed = shouldReverse;
+    }
+
+    void DelayLine::updateLoopMode()
+    {
+        const auto requested = frozen ? LoopMode::frozen : (reversed ? LoopMode::reversed : LoopMode::normal);
+        
+        if (requested == activeMode)
+            return;
+            
+        // The outgoing mode becomes the fading head, continuing from exactly where it is.
+        // A change during a fade cuts the older fading head short.
+        fadingMode = activeMode;
+        
+        if (fadingMode == LoopMode::normal)
+        {
+            fadingDelay = juce::jmax(1.0f, getOutputDelayTime(delayTimeInSamples));
+            fadingFromDelay = juce::jmax(1.0f, getOutputDelayTime(retargetFromInSamples));
+            fadingRetargetPosition = retargetPosition;
+        }
+        else if (fadingMode == LoopMode::frozen)
+        {
+            fadingPosition = frozenPosition;
+            fadingHead = 0;
+        }
+        else
+        {
+            fadingPosition = reversePosition;
+            fadingHead = 2 * reversePosition + 1;
+            fadingPreviousHead = 2 * (previousReverseLength + reversePosition) + 1;
+        }
+        
+        if (requested == LoopMode::frozen)
+        {
+            // Capture the last delay time's worth, leaving room for the seam fade's lead-in
+            // and for the loop to fade out as the write position moves on after release
+            frozenLength = juce::jlimit(loopFadeLength, juce::jmax(loopFadeLength, delayLine.getMaximumDelayInSamples() - 2 * loopFadeLength),
+                                        static_cast<int>(getValidDelayTime()));
+            frozenPosition = 0;
+        }
+        else if (requested == LoopMode::reversed)
+        {
+            // The first chunk fades in over older audio, which is harmless
+            reverseLength = juce::jlimit(loopFadeLength, getMaximumReverseLength(), static_cast<int>(getValidDelayTime()));
+            previousReverseLength = reverseLength;
+            reversePosition = 0;
+        }
+        
+        activeMode = requested;
+        modeFadePosition = 0;
+    }
+
     float DelayLine::processSample(float inputSample)
     {
         // Safety check - ensure the delay line is properly initialized
         if (delayLine.getMaximumDelayInSamples() <= 0)
             return inputSample; // Pass through if not initialized
             
-        // Allow extremely small delay times (as low as 2 samples in ms equivalent)
-        // For linear interpolation to work properly, set absolute minimum to slightly above 0
-        const float absoluteMinDelayTime = 0.01f; // Absolute minimum for safety
-        
         // Make sure delay time is valid between minimum and maximum
-        float validDelayTime = juce::jmax(absoluteMinDelayTime, 
-                                         juce::jmin(delayTimeInSamples, 
-                                                   static_cast<float>(delayLine.getMaximumDelayInSamples() - 1)));
+        const float validDelayTime = getValidDelayTime();
         
         // Get delayed sample safely
         float delaySample;
         try {
             delaySample = delayLine.popSample(0, validDelayTime);
+            
+            if (isRetargeting())
+                delaySample = delayLine.popSample(0, getValidDelayTime(retargetFromInSamples)) * retargetFadeOut[static_cast<size_t>(retargetPosition)]
+                            + delaySample * retargetFadeIn[static_cast<size_t>(retargetPosition)];
         }
         catch (...) {
             // If any exception occurs, reset and pass through
@@ -105,6 +357,7 @@ namespace EchoSphere
         
         // Store for next iteration
         lastSample = delaySample;
+        advanceRetarget(1);
         
         // Calculate mixed output (dry/wet)
         return inputSample * (1.0f - mix) + delaySample * mix;
@@ -122,15 +375,467 @@ namespace EchoSphere
         if (channelData == nullptr)
             return;
             
-        for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
+        // Safety check - ensure the delay line is properly initialized
+        if (delayLine.getMaximumDelayInSamples() <= 0)
+            return; // Pass through if not initialized
+            
+        const auto& dsp = Kernels::get();
+        updateLoopMode();
+        
+        if (wetPathDivisor > 1 || shimmer > 0.0f || isLoopModeActive())
         {
-            channelData[sample] = processSample(channelData[sample]);
+            // Decimated, shimmering or looping feedback loop, then the dry/wet mix at the host rate
+            for (int start = 0; start < buffer.getNumSamples(); start += maxBlockSize)
+            {
+                const int numSamples = juce::jmin(maxBlockSize, buffer.getNumSamples() - start);
+                processWetPath(channelData + start, hostRateWet.data(), numSamples);
+                dsp.mixDryWet(channelData + start, hostRateWet.data(), 1.0f - mix, mix, numSamples);
+            }
+            
+            return;
         }
+        
+        for (int start = 0; start < buffer.getNumSamples();)
+        {
+            // Chunks never exceed the integer delay, so every read comes from samples
+            // written before the chunk and both windows are single contiguous runs
+            const int numSamples = limitChunkForRetarget(juce::jmin(getMaximumChunkSize(getValidDelayTime()),
+                                                                    buffer.getNumSamples() - start));
+            const auto tap = getLoopTap(numSamples);
+            
+            getDelayKernel(dsp, numSamples)(channelData + start, delayLine.getWritePointer(), tap.older,
+                                            tap.fraction, feedback, 1.0f - mix, mix, numSamples);
+            delayLine.advanceWritePosition(numSamples);
+            advanceRetarget(numSamples);
+            start += numSamples;
+        }
+        
+        lastSample = delayLine.popSample(0, getValidDelayTime() + 1.0f);
+    }
+
+    void DelayLine::processMidSideBlock(DelayLine& sideLine, juce::AudioBuffer<float>& buffer)
+    {
+        // Mid/side needs a stereo pair; fall back to plain processing otherwise
+        if (buffer.getNumChannels() < 2)
+        {
+            processBlock(buffer, 0);
+            return;
+        }
+        
+        // Safety check - ensure both delay lines are properly initialized
+        if (delayLine.getMaximumDelayInSamples() <= 0 || sideLine.delayLine.getMaximumDelayInSamples() <= 0)
+            return;
+            
+        auto* left = buffer.getWritePointer(0);
+        auto* right = buffer.getWritePointer(1);
+        
+        if (left == nullptr || right == nullptr)
+            return;
+            
+        updateLoopMode();
+        sideLine.updateLoopMode();
+        
+        if ((wetPathDivisor > 1 || shimmer > 0.0f || sideLine.shimmer > 0.0f || isLoopModeActive() || sideLine.isLoopModeActive())
+            && sideLine.wetPathDivisor == wetPathDivisor)
+        {
+            const float dryGain = 1.0f - mix;
+            const float wetGain = mix;
+            
+            for (int start = 0; start < buffer.getNumSamples(); start += maxBlockSize)
+            {
+                const int numSamples = juce::jmin(maxBlockSize, buffer.getNumSamples() - start);
+                auto* midWet = hostRateWet.data();
+                auto* sideWet = sideLine.hostRateWet.data();
+                
+                // Encode: [M S] = 0.5 * [1 1; 1 -1] [L R]
+                for (int i = 0; i < numSamples; ++i)
+                {
+                    midWet[i] = 0.5f * (left[start + i] + right[start + i]);
+                    sideWet[i] = 0.5f * (left[start + i] - right[start + i]);
+                }
+                
+                // Both loops run through their wet paths; the resamplers work in place
+                processWetPath(midWet, midWet, numSamples);
+                sideLine.processWetPath(sideWet, sideWet, numSamples);
+                
+                // Decode: [L R] = [1 1; 1 -1] [M S], folded into the dry/wet mix
+                for (int i = 0; i < numSamples; ++i)
+                {
+                    left[start + i] = left[start + i] * dryGain + (midWet[i] + sideWet[i]) * wetGain;
+                    right[start + i] = right[start + i] * dryGain + (midWet[i] - sideWet[i]) * wetGain;
+                }
+            }
+            
+            return;
+        }
+        
+        const auto& dsp = Kernels::get();
+        
+        for (int start = 0; start < buffer.getNumSamples();)
+        {
+            int numSamples = juce::jmin(getMaximumChunkSize(getValidDelayTime()), sideLine.getMaximumChunkSize(sideLine.getValidDelayTime()),
+                                        buffer.getNumSamples() - start);
+            numSamples = sideLine.limitChunkForRetarget(limitChunkForRetarget(numSamples));
+            
+            const auto midTap = getLoopTap(numSamples);
+            const auto sideTap = sideLine.getLoopTap(numSamples);
+            
+            getMidSideDelayKernel(dsp, numSamples)(left + start, right + start,
+                                                   delayLine.getWritePointer(), sideLine.delayLine.getWritePointer(),
+                                                   midTap.older, sideTap.older, midTap.fraction, sideTap.fraction,
+                                                   feedback, sideLine.feedback, 1.0f - mix, mix, numSamples);
+            delayLine.advanceWritePosition(numSamples);
+            sideLine.delayLine.advanceWritePosition(numSamples);
+            advanceRetarget(numSamples);
+            sideLine.advanceRetarget(numSamples);
+            start += numSamples;
+        }
+        
+        lastSample = delayLine.popSample(0, getValidDelayTime() + 1.0f);
+        sideLine.lastSample = sideLine.delayLine.popSample(0, sideLine.getValidDelayTime() + 1.0f);
+    }
+
+    void DelayLine::processWetPath(const float* input, float* wetOutput, int numSamples)
+    {
+        // The resampler reads all of its input before it writes any output, so in place is fine
+        const int numLowRate = resampler.downsample(input, numSamples, lowRateInput.data());
+        
+        for (int start = 0; start < numLowRate;)
+        {
+            if (isModeFading())
+                start += processModeFade(lowRateInput.data() + start, lowRateWet.data() + start, numLowRate - start);
+            else
+                start += processModeChunk(lowRateInput.data() + start, lowRateWet.data() + start, numLowRate - start);
+        }
+        
+        if (numLowRate > 0)
+            lastSample = lowRateWet[static_cast<size_t>(numLowRate - 1)];
+        
+        resampler.upsample(lowRateWet.data(), numLowRate);
+        resampler.pull(wetOutput, numSamples);
+    }
+
+    int DelayLine::processModeChunk(float* input, float* wetOutput, int numSamples)
+    {
+        if (activeMode == LoopMode::normal)
+            return processDelayChunk(input, wetOutput, numSamples);
+            
+        // The loop modes ignore the delay time, but a running crossfade or a scheduled change
+        // still counts down underneath them rather than waiting for the release
+        numSamples = limitChunkForRetarget(numSamples);
+        std::copy(input, input + numSamples, wetOutput);
+        
+        if (activeMode == LoopMode::frozen)
+            processFrozen(wetOutput, 0.0f, 1.0f, numSamples, frozenPosition, 0);
+        else
+            processReversed(wetOutput, 0.0f, 1.0f, numSamples);
+            
+        advanceRetarget(numSamples);
+        return numSamples;
+    }
+
+    int DelayLine::processDelayChunk(float* input, float* wetOutput, int numSamples)
+    {
+        const auto& dsp = Kernels::get();
+        
+        // The loop taps at the full delay, so repeats stay exactly one delay time apart.
+        // The output tap is earlier by the resampler latency, which puts the first repeat
+        // on time too (delays shorter than that latency come out at the latency).
+        const float loopDelay = getValidDelayTime();
+        int chunk = limitChunkForRetarget(juce::jmin(getMaximumChunkSize(loopDelay), numSamples));
+        
+        // Grains only read samples from before this chunk, so they run first and
+        // may cut it short at a grain boundary
+        if (shimmer > 0.0f)
+            chunk = pitchShifter.process(delayLine, loopDelay, shiftedWet.data(), chunk);
+            
+        const auto tap = getLoopTap(chunk);
+        
+        // Feedback write only; the kernel's mixed output (pure delayed signal) is discarded
+        if (shimmer > 0.0f)
+            dsp.shimmerDelayBlock(input, delayLine.getWritePointer(), tap.older, shiftedWet.data(),
+                                  tap.fraction, shimmer, feedback, 0.0f, 1.0f, chunk);
+        else
+            getDelayKernel(dsp, chunk)(input, delayLine.getWritePointer(), tap.older,
+                                       tap.fraction, feedback, 0.0f, 1.0f, chunk);
+            
+        delayLine.advanceWritePosition(chunk);
+        
+        // Output tap, now that the chunk it may read from has been written. It crossfades
+        // over the same span as the loop tap.
+        const float outputDelay = getOutputDelayTime(delayTimeInSamples);
+        const int outputDelayInt = static_cast<int>(outputDelay);
+        
+        if (isRetargeting())
+        {
+            const float fromOutputDelay = getOutputDelayTime(retargetFromInSamples);
+            const int fromOutputDelayInt = static_cast<int>(fromOutputDelay);
+            
+            dsp.crossfadeTapBlock(wetOutput, delayLine.getReadPointer(chunk + fromOutputDelayInt + 1),
+                                  delayLine.getReadPointer(chunk + outputDelayInt + 1),
+                                  fromOutputDelay - static_cast<float>(fromOutputDelayInt),
+                                  outputDelay - static_cast<float>(outputDelayInt),
+                                  retargetFadeOut.data() + retargetPosition, retargetFadeIn.data() + retargetPosition, chunk);
+        }
+        else
+        {
+            dsp.interpolateBlock(wetOutput, delayLine.getReadPointer(chunk + outputDelayInt + 1),
+                                 outputDelay - static_cast<float>(outputDelayInt), chunk);
+        }
+        
+        advanceRetarget(chunk);
+        return chunk;
+    }
+
+    int DelayLine::processModeFade(float* input, float* wetOutput, int numSamples)
+    {
+        // The new mode runs first, since it may cut the chunk short; the fading head reads
+        // nothing it could have written
+        const int limit = limitChunkForFade(juce::jmin(numSamples, loopFadeLength - modeFadePosition));
+        const int chunk = processModeChunk(input, modeFadeTo.data(), limit);
+        
+        readFadingHead(modeFadeFrom.data(), chunk, activeMode == LoopMode::frozen ? 0 : chunk);
+        
+        Kernels::get().crossfadeMixBlock(wetOutput, modeFadeFrom.data(), modeFadeTo.data(),
+                                         loopFade.data() + modeFadePosition, 0.0f, 1.0f, chunk);
+        modeFadePosition += chunk;
+        return chunk;
+    }
+
+    int DelayLine::limitChunkForFade(int numSamples) const
+    {
+        // A forward read must stop short of the write position (both delays are at least 1)
+        if (fadingMode == LoopMode::normal)
+        {
+            numSamples = juce::jmin(numSamples, static_cast<int>(fadingDelay));
+            
+            if (fadingRetargetPosition < retargetLength)
+                numSamples = juce::jmin(numSamples, static_cast<int>(fadingFromDelay), retargetLength - fadingRetargetPosition);
+        }
+        
+        return numSamples;
+    }
+
+    void DelayLine::readFadingHead(float* output, int numSamples, int numWritten)
+    {
+        const auto& dsp = Kernels::get();
+        
+        if (fadingMode == LoopMode::normal)
+        {
+            const int delayInt = static_cast<int>(fadingDelay);
+            const float* older = delayLine.getReadPointer(numWritten + delayInt + 1);
+            
+            if (fadingRetargetPosition < retargetLength)
+            {
+                const int fromDelayInt = static_cast<int>(fadingFromDelay);
+                
+                dsp.crossfadeTapBlock(output, delayLine.getReadPointer(numWritten + fromDelayInt + 1), older,
+                                      fadingFromDelay - static_cast<float>(fromDelayInt), fadingDelay - static_cast<float>(delayInt),
+                                      retargetFadeOut.data() + fadingRetargetPosition, retargetFadeIn.data() + fadingRetargetPosition,
+                                      numSamples);
+                fadingRetargetPosition += numSamples;
+            }
+            else
+            {
+                dsp.interpolateBlock(output, older, fadingDelay - static_cast<float>(delayInt), numSamples);
+            }
+            
+            fadingDelay += static_cast<float>(numWritten - numSamples);
+            fadingFromDelay += static_cast<float>(numWritten - numSamples);
+            
+            // Only freeze stops the writes. A delay shorter than the fade then runs out of
+            // recorded audio and wraps onto the frozen loop, which is as close as it gets.
+            if (fadingDelay < 1.0f)
+                fadingDelay += static_cast<float>(frozenLength);
+                
+            if (fadingFromDelay < 1.0f)
+                fadingFromDelay += static_cast<float>(frozenLength);
+        }
+        else if (fadingMode == LoopMode::frozen)
+        {
+            fadingHead += numWritten;
+            processFrozen(output, 0.0f, 1.0f, numSamples, fadingPosition, fadingHead);
+        }
+        else
+        {
+            // processReversed without new chunks, feedback or writes: modeFadeScratch takes
+            // the kernels' feedback write
+            for (int start = 0; start < numSamples;)
+            {
+                int chunk = numSamples - start;
+                
+                if (fadingPosition < loopFadeLength)
+                {
+                    chunk = juce::jmin(chunk, loopFadeLength - fadingPosition);
+                    
+                    dsp.reverseCrossfadeDelayBlock(output + start, modeFadeScratch.data(),
+                                                   delayLine.getReadPointer(numWritten + fadingHead + chunk - 1),
+                                                   delayLine.getReadPointer(numWritten + fadingPreviousHead + chunk - 1),
+                                                   loopFade.data() + fadingPosition, 0.0f, 0.0f, 1.0f, chunk);
+                }
+                else
+                {
+                    dsp.reverseDelayBlock(output + start, modeFadeScratch.data(),
+                                          delayLine.getReadPointer(numWritten + fadingHead + chunk - 1),
+                                          0.0f, 0.0f, 1.0f, chunk);
+                }
+                
+                fadingHead += chunk;
+                fadingPreviousHead += chunk;
+                fadingPosition += chunk;
+                start += chunk;
+            }
+            
+            fadingHead += numWritten;
+            fadingPreviousHead += numWritten;
+        }
+    }
+
+    void DelayLine::processFrozen(float* io, float dryGain, float wetGain, int numSamples, int& position, int readOffset)
+    {
+        const auto& dsp = Kernels::get();
+        const int seamStart = frozenLength - loopFadeLength;
+        
+        // Nothing is written while frozen, so the loop is the frozenLength samples behind
+        // the write position freeze found, which is readOffset behind the current one
+        for (int start = 0; start < numSamples;)
+        {
+            const float* loop = delayLine.getReadPointer(readOffset + frozenLength - position);
+            
+            if (position < seamStart)
+            {
+                const int chunk = juce::jmin(numSamples - start, seamStart - position);
+                dsp.mixDryWet(io + start, loop, dryGain, wetGain, chunk);
+                position += chunk;
+                start += chunk;
+            }
+            else
+            {
+                // Fade the loop's end into the audio that led up to its start, so the jump
+                // back lands on continuous material
+                const int fadePosition = position - seamStart;
+                const int chunk = juce::jmin(numSamples - start, frozenLength - position);
+                const float* leadIn = delayLine.getReadPointer(readOffset + 2 * frozenLength - position);
+                
+                dsp.crossfadeMixBlock(io + start, loop, leadIn, loopFade.data() + fadePosition, dryGain, wetGain, chunk);
+                position += chunk;
+                start += chunk;
+                
+                if (position == frozenLength)
+                    position = 0;
+            }
+        }
+    }
+
+    void DelayLine::processReversed(float* io, float dryGain, float wetGain, int numSamples)
+    {
+        const auto& dsp = Kernels::get();
+        
+        // Output k of a chunk started at time T plays x[T - 1 - k], which is 2k + 1 behind the
+        // write position. For the first loopFadeLength samples the previous chunk's head
+        // keeps going (further back, 2 * previousLength more) while it fades out.
+        for (int start = 0; start < numSamples;)
+        {
+            if (reversePosition == reverseLength)
+            {
+                // Chunk boundary: pick up the current delay time
+                previousReverseLength = reverseLength;
+                reverseLength = juce::jlimit(loopFadeLength, getMaximumReverseLength(), static_cast<int>(getValidDelayTime()));
+                reversePosition = 0;
+            }
+            
+            int chunk = juce::jmin(numSamples - start, reverseLength - reversePosition, delayLine.getMaximumBlockSize());
+            
+            // Windows are passed by their oldest sample, so the mirror keeps them contiguous
+            if (reversePosition < loopFadeLength)
+            {
+                chunk = juce::jmin(chunk, loopFadeLength - reversePosition);
+                
+                dsp.reverseCrossfadeDelayBlock(io + start, delayLine.getWritePointer(),
+                                               delayLine.getReadPointer(2 * reversePosition + chunk),
+                                               delayLine.getReadPointer(2 * (previousReverseLength + reversePosition) + chunk),
+                                               loopFade.data() + reversePosition, feedback, dryGain, wetGain, chunk);
+            }
+            else
+            {
+                dsp.reverseDelayBlock(io + start, delayLine.getWritePointer(),
+                                      delayLine.getReadPointer(2 * reversePosition + chunk),
+                                      feedback, dryGain, wetGain, chunk);
+            }
+            
+            delayLine.advanceWritePosition(chunk);
+            reversePosition += chunk;
+            start += chunk;
+        }
+    }
+
+    int DelayLine::getMaximumReverseLength() const
+    {
+        // The fading head reaches 2 * (length + fade) behind the write position
+        return juce::jmax(loopFadeLength, (delayLine.getMaximumDelayInSamples() - 1) / 2 - loopFadeLength);
+    }
+
+    float DelayLine::getValidDelayTime() const
+    {
+        return getValidDelayTime(delayTimeInSamples);
+    }
+
+    float DelayLine::getValidDelayTime(float delayInSamples) const
+    {
+        // Allow extremely small delay times (as low as 2 samples in ms equivalent)
+        // A read must come from a sample that has already been written, so the absolute
+        // minimum is one whole sample
+        const float absoluteMinDelayTime = 1.0f;
+        
+        return juce::jmax(absoluteMinDelayTime, 
+                          juce::jmin(delayInSamples / static_cast<float>(wetPathDivisor), 
+                                     static_cast<float>(delayLine.getMaximumDelayInSamples() - 1)));
+    }
+
+    float DelayLine::getOutputDelayTime(float delayInSamples) const
+    {
+        return juce::jlimit(0.0f, getValidDelayTime(delayInSamples),
+                            (delayInSamples - static_cast<float>(resampler.getLatencyInSamples())) / static_cast<float>(wetPathDivisor));
+    }
+
+    int DelayLine::getMaximumChunkSize(float validDelayTime) const
+    {
+        // A chunk longer than the integer delay would read samples it is about to write
+        return juce::jlimit(1, delayLine.getMaximumBlockSize(), static_cast<int>(validDelayTime));
+    }
+
+    Kernels::DelayBlockFunction DelayLine::getDelayKernel(const Kernels::Table& dsp, int numSamples) const
+    {
+        if (fixedBlockIndex >= 0 && numSamples == Kernels::fixedBlockSizes[fixedBlockIndex])
+            return dsp.delayBlockFixed[fixedBlockIndex];
+            
+        return dsp.delayBlock;
+    }
+
+    Kernels::MidSideDelayBlockFunction DelayLine::getMidSideDelayKernel(const Kernels::Table& dsp, int numSamples) const
+    {
+        if (fixedBlockIndex >= 0 && numSamples == Kernels::fixedBlockSizes[fixedBlockIndex])
+            return dsp.midSideDelayBlockFixed[fixedBlockIndex];
+            
+        return dsp.midSideDelayBlock;
+    }
+
+    bool DelayLine::lockMemory()
+    {
+        return delayLine.lockMemory();
     }
 
     void DelayLine::reset()
     {
         delayLine.reset();
+        resampler.reset();
+        pitchShifter.reset();
         lastSample = 0.0f;
+        
+        // Nothing left in the buffer to fade from
+        retargetPosition = retargetLength;
+        modeFadePosition = loopFadeLength;
+        hasPendingDelayTime = false;
+        samplesUntilScheduled = -1;
     }
 } 
\ No newline at end of file
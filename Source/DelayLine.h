@@ -1,6 +1,10 @@
 #pragma once
 
 #include "JuceHeader.h"
+#include "MirroredRingBuffer.h"
+#include "DSPKernels.h"
+#include "Multirate.h"
+#include "GrainPitchShifter.h"
 
 namespace EchoSphere
 {
@@ -10,33 +14,217 @@ namespace EchoSphere
         DelayLine();
         ~DelayLine();
         
-        // Initialize the delay line with sample rate
-        void prepare(double sampleRate, int maxDelayTimeMs = 5000);
+        DelayLine(DelayLine&&) noexcept = default;
+        DelayLine& operator=(DelayLine&&) noexcept = default;
         
-        // Set the delay time in milliseconds
+        // Initialize the delay line with sample rate and the host's maximum block size.
+        // This is where the ring buffer is allocated and prefaulted.
+        // A wetPathDivisor of 2 or 4 runs the feedback loop at that fraction of the
+        // sample rate, with the ring buffer shrunk to match.
+        void prepare(double sampleRate, int samplesPerBlock, int wetPathDivisor = 1, int maxDelayTimeMs = 5000);
+        
+        // Set the delay time in milliseconds. A change crossfades from the old read position
+        // to the new one (see retargetFadeMs) instead of jumping; a change that arrives
+        // during a crossfade is queued, latest value wins.
         void setDelayTime(float delayTimeMs);
         
+        // Like setDelayTime, but the crossfade starts sampleOffset samples into the audio
+        // processed from here on (which may be a later block). Replaces any earlier schedule.
+        void scheduleDelayTime(float delayTimeMs, int sampleOffset);
+        
+        // Length of the read-head crossfade on a delay time change
+        static constexpr double retargetFadeMs = 20.0;
+        
         // Set the feedback amount (0.0 - 1.0)
         void setFeedback(float feedbackAmount);
         
         // Set the wet/dry mix (0.0 - 1.0)
         void setMix(float wetDryMix);
         
-        // Process a single sample through the delay
+        // Pitch shift applied to the shimmer part of the feedback, in semitones
+        void setPitchShift(float semitones);
+        
+        // How much of the feedback goes through the pitch shifter (0 - 100%). Each repeat
+        // is shifted once more than the last; 0 takes the shifter out of the loop entirely.
+        void setShimmer(float shimmerAmount);
+        
+        // Freeze: stop writing and loop the last delay time's worth of the buffer. Engaging
+        // captures the loop length; the delay time has no effect until it's released.
+        // Switching in or out crossfades over 5 ms at the start of the next block.
+        void setFreeze(bool shouldFreeze);
+        
+        // Reverse: play each delay-time-long chunk backwards once it has been recorded,
+        // feeding the reversed signal back. Freeze takes precedence. Crossfaded like freeze.
+        void setReverse(bool shouldReverse);
+        
+        // Process a single sample through the delay (always at the buffer's rate, so only
+        // meaningful when prepared with a wet path divisor of 1; shimmer is not applied)
         float processSample(float inputSample);
         
         // Process a block of audio
         void processBlock(juce::AudioBuffer<float>& buffer, int channel);
         
+        // Process a stereo block in mid/side: this line carries mid, sideLine carries side.
+        // Encode, feedback and decode all happen in a single pass over both channels.
+        void processMidSideBlock(DelayLine& sideLine, juce::AudioBuffer<float>& buffer);
+        
         // Reset the delay line's internal state
         void reset();
         
+        // Pin the delay memory (already prefaulted by prepare) in RAM; false if not allowed
+        bool lockMemory();
+        
     private:
-        juce::dsp::DelayLine<float, juce::dsp::DelayLineInterpolationTypes::Linear> delayLine;
+        // Current delay time clamped to what the buffer can provide
+        float getValidDelayTime() const;
+        
+        // Any delay in host-rate samples, converted to the buffer's rate and clamped
+        float getValidDelayTime(float delayInSamples) const;
+        
+        // Multirate output tap for a host-rate delay, ahead of the loop tap by the resampler latency
+        float getOutputDelayTime(float delayInSamples) const;
+        
+        // Start crossfading to a new delay (host-rate samples), or queue it if one is running
+        void startRetarget(float newDelayInSamples);
+        
+        bool isRetargeting() const noexcept { return retargetPosition < retargetLength; }
+        
+        // Shortens a chunk so it ends by the end of the crossfade or the scheduled change,
+        // and so the old head's reads are also all from before the chunk
+        int limitChunkForRetarget(int numSamples) const;
+        
+        // Read window for the loop tap over the next numSamples: the fixed-offset one, or while
+        // a crossfade runs, both heads mixed into retargetTap, laid out so that the delay
+        // kernels read it as a whole-sample delay
+        struct LoopTap
+        {
+            const float* older;
+            float fraction;
+        };
+        
+        LoopTap getLoopTap(int numSamples);
+        
+        // Move the crossfade and the schedule countdown on by numSamples
+        void advanceRetarget(int numSamples);
+        
+        // Samples that can go through the block kernel before a read would need one of
+        // the samples being written (at least 1)
+        int getMaximumChunkSize(float validDelayTime) const;
+        
+        // Wet path for the multirate and shimmer cases: input at the host rate in, delayed
+        // signal at the host rate out (input and wetOutput may be the same buffer)
+        void processWetPath(const float* input, float* wetOutput, int numSamples);
+        
+        enum class LoopMode
+        {
+            normal,
+            frozen,
+            reversed
+        };
+        
+        // Picks up freeze/reverse changes: the new mode starts from its beginning and the
+        // old one carries on as the fading head
+        void updateLoopMode();
+        
+        bool isModeFading() const noexcept { return modeFadePosition < loopFadeLength; }
+        
+        // Freeze or reverse is playing, or fading out; either way it takes the wet path
+        bool isLoopModeActive() const noexcept { return activeMode != LoopMode::normal || isModeFading(); }
+        
+        // Runs the active mode over at most numSamples at the buffer's rate and returns how
+        // many it did. input is overwritten; wetOutput gets the delayed signal alone.
+        int processModeChunk(float* input, float* wetOutput, int numSamples);
+        int processDelayChunk(float* input, float* wetOutput, int numSamples);
+        
+        // processModeChunk while a mode change crossfades, mixing in the fading head
+        int processModeFade(float* input, float* wetOutput, int numSamples);
+        
+        // The fading head only reads samples from before the chunk, after the new mode has
+        // written numWritten of its own, so the chunk may have to be shorter
+        int limitChunkForFade(int numSamples) const;
+        void readFadingHead(float* output, int numSamples, int numWritten);
+        
+        // io holds the input and is replaced with input * dryGain + loop output * wetGain.
+        // The frozen loop is readOffset further back when the write position has moved on
+        // since it was captured (as the fading head after a release).
+        void processFrozen(float* io, float dryGain, float wetGain, int numSamples, int& position, int readOffset);
+        void processReversed(float* io, float dryGain, float wetGain, int numSamples);
+        
+        // Longest reverse chunk the buffer can hold along with the previous one's fade tail
+        int getMaximumReverseLength() const;
+        
+        // Picks the fixed-length kernel when a chunk is exactly the prepared block size
+        Kernels::DelayBlockFunction getDelayKernel(const Kernels::Table& dsp, int numSamples) const;
+        Kernels::MidSideDelayBlockFunction getMidSideDelayKernel(const Kernels::Table& dsp, int numSamples) const;
+        
+        MirroredRingBuffer delayLine;
         float feedback;
         float mix;
         double currentSampleRate;
         float delayTimeInSamples;
         float lastSample;
+        int fixedBlockIndex;
+        
+        // Shimmer stage in the feedback path, running at the loop's rate
+        GrainPitchShifter pitchShifter;
+        float shimmer;
+        std::vector<float> shiftedWet;
+        
+        // Freeze and reverse play straight out of the ring buffer, with loopFade (a raised
+        // cosine, fadeIn[j] + fadeIn[length - 1 - j] == 1) across every seam
+        std::vector<float> loopFade;
+        int loopFadeLength;
+        bool frozen;
+        int frozenLength;
+        int frozenPosition;
+        bool reversed;
+        int reverseLength;
+        int previousReverseLength;
+        int reversePosition;
+        
+        // Mode changes fade over loopFade too. While modeFadePosition < loopFadeLength the
+        // fading head keeps playing fadingMode from where it was, with its offsets counted
+        // behind the write position at the start of the next chunk:
+        //   normal:   fadingDelay, read forwards and interpolated, along with fadingFromDelay
+        //             if a retarget crossfade was running (until fadingRetargetPosition ends it)
+        //   frozen:   fadingPosition in the loop, fadingHead samples written since the release
+        //   reversed: fadingHead read backwards, fadingPreviousHead while the chunk's own
+        //             fade (fadingPosition < loopFadeLength) is still running
+        LoopMode activeMode;
+        LoopMode fadingMode;
+        int modeFadePosition;
+        float fadingDelay;
+        float fadingFromDelay;
+        int fadingRetargetPosition;
+        int fadingHead;
+        int fadingPreviousHead;
+        int fadingPosition;
+        std::vector<float> modeFadeFrom;
+        std::vector<float> modeFadeTo;
+        std::vector<float> modeFadeScratch;
+        
+        // Delay time retargeting. Steady state reads one head at a fixed offset; only while
+        // retargetPosition < retargetLength does a second head run at retargetFromInSamples,
+        // weighted by the equal-power fade tables. Positions and lengths are at the
+        // buffer's rate.
+        std::vector<float> retargetFadeIn;
+        std::vector<float> retargetFadeOut;
+        std::vector<float> retargetTap;
+        int retargetLength;
+        int retargetPosition;
+        float retargetFromInSamples;
+        bool hasDelayTime;
+        bool hasPendingDelayTime;
+        float pendingDelayInSamples;
+        int samplesUntilScheduled;
+        float scheduledDelayInSamples;
+        
+        // Multirate state (unused when wetPathDivisor is 1)
+        WetPathResampler resampler;
+        int wetPathDivisor;
+        int maxBlockSize;
+        std::vector<float> lowRateInput;
+        std::vector<float> lowRateWet;
+        std::vector<float> hostRateWet;
     };
 } 
\ No newline at end of file
@@ -0,0 +1,133 @@
+#include "GrainPitchShifter.h"
+
+namespace EchoSphere
+{
+    void GrainPitchShifter::prepare(double sampleRate, int maxBlockSize)
+    {
+        // A whole number of hops per grain keeps the overlap-add exact
+        hopSize = juce::jmax(1, juce::roundToInt(grainLengthMs * 0.001 * sampleRate / Kernels::maxGrains));
+        grainLength = hopSize * Kernels::maxGrains;
+
+        window.assign(static_cast<size_t>(grainLength + juce::jmax(1, maxBlockSize)), 0.0f);
+
+        // Periodic Hann windows spaced a hop apart sum to maxGrains / 2; scale that to unity
+        const double gain = 2.0 / Kernels::maxGrains;
+
+        for (int k = 0; k < grainLength; ++k)
+            window[static_cast<size_t>(k)] = static_cast<float>(gain * 0.5
+                                                                * (1.0 - std::cos(juce::MathConstants<double>::twoPi * k / grainLength)));
+
+        reset();
+    }
+
+    void GrainPitchShifter::reset() noexcept
+    {
+        for (int slot = 0; slot < Kernels::maxGrains; ++slot)
+        {
+            grainAge[slot] = grainLength;
+            grainDelay[slot] = 0.0f;
+            grainRate[slot] = 1.0f;
+        }
+
+        samplesUntilNextGrain = 0;
+        started = false;
+    }
+
+    void GrainPitchShifter::setSemitones(float semitones) noexcept
+    {
+        pitchRatio = std::pow(2.0f, semitones / 12.0f);
+    }
+
+    int GrainPitchShifter::process(const MirroredRingBuffer& buffer, float centreDelay, float* output, int numSamples) noexcept
+    {
+        jassert(numSamples <= static_cast<int>(window.size()) - grainLength);
+
+        const int maxDelay = buffer.getMaximumDelayInSamples();
+
+        if (!started)
+        {
+            // Start with every slot part way through, so the output is at full level at once
+            for (int slot = 0; slot < Kernels::maxGrains; ++slot)
+                startGrain(slot, slot * hopSize, centreDelay, maxDelay);
+
+            samplesUntilNextGrain = hopSize;
+            started = true;
+        }
+        else if (samplesUntilNextGrain == 0)
+        {
+            // The oldest grain has just finished; the new one takes its slot
+            for (int slot = 0; slot < Kernels::maxGrains; ++slot)
+            {
+                if (grainAge[slot] >= grainLength)
+                {
+                    startGrain(slot, 0, centreDelay, maxDelay);
+                    break;
+                }
+            }
+
+            samplesUntilNextGrain = hopSize;
+        }
+
+        // Stop at the next grain start, and before any grain's upper interpolation tap
+        // reaches the write position
+        numSamples = juce::jmin(numSamples, samplesUntilNextGrain);
+        float furthestDelay = 1.0f;
+
+        for (int slot = 0; slot < Kernels::maxGrains; ++slot)
+        {
+            if (grainAge[slot] < grainLength)
+            {
+                numSamples = juce::jmin(numSamples, juce::jmax(1, static_cast<int>((grainDelay[slot] - 2.0f) / grainRate[slot]) + 1));
+                furthestDelay = juce::jmax(furthestDelay, grainDelay[slot]);
+            }
+        }
+
+        // Source offsets are measured from the oldest sample any grain reads, which keeps
+        // them small enough to stay precise as floats. Idle slots sit on the window's zero
+        // tail, reading one fixed sample.
+        const int baseDelay = static_cast<int>(std::ceil(furthestDelay));
+
+        for (int slot = 0; slot < Kernels::maxGrains; ++slot)
+        {
+            const bool active = grainAge[slot] < grainLength;
+            windowOffset[slot] = active ? grainAge[slot] : grainLength;
+            sourceOffset[slot] = active ? static_cast<float>(baseDelay) - grainDelay[slot] : 0.0f;
+            sourceRate[slot] = active ? grainRate[slot] : 0.0f;
+        }
+
+        Kernels::get().grainOverlapAdd(output, buffer.getReadPointer(baseDelay), window.data(),
+                                       windowOffset, sourceOffset, sourceRate, numSamples);
+
+        // Grains end exactly on a hop boundary, so none retires part way through the call
+        for (int slot = 0; slot < Kernels::maxGrains; ++slot)
+        {
+            if (grainAge[slot] < grainLength)
+            {
+                grainAge[slot] += numSamples;
+                grainDelay[slot] -= (grainRate[slot] - 1.0f) * static_cast<float>(numSamples);
+            }
+        }
+
+        samplesUntilNextGrain -= numSamples;
+        return numSamples;
+    }
+
+    void GrainPitchShifter::startGrain(int slot, int age, float centreDelay, int maxDelay) noexcept
+    {
+        // Keep the whole sweep inside the buffer: at least two samples behind the write
+        // position and no further back than the oldest sample
+        const float spread = std::abs(pitchRatio - 1.0f) * 0.5f * static_cast<float>(grainLength);
+        
+        // Jittering each grain by up to a hop varies the phase between overlapping grains,
+        // so their cancellation moves around instead of notching fixed frequencies. Near
+        // unison the grains line up on their own, so the jitter fades out below a semitone.
+        const float jitterAmount = juce::jmin(1.0f, std::abs(pitchRatio - 1.0f) / (std::pow(2.0f, 1.0f / 12.0f) - 1.0f));
+        const float jitter = random.nextFloat() * jitterAmount * static_cast<float>(hopSize);
+        const float centre = juce::jmax(2.0f + spread, juce::jmin(static_cast<float>(maxDelay - 1) - spread, centreDelay + jitter));
+
+        // The delay changes by 1 - ratio per sample and passes the centre halfway through
+        grainAge[slot] = age;
+        grainRate[slot] = pitchRatio;
+        grainDelay[slot] = centre + (pitchRatio - 1.0f) * (0.5f * static_cast<float>(grainLength) - static_cast<float>(age));
+    }
+}
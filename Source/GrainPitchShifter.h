@@ -0,0 +1,58 @@
+#pragma once
+
+#include "JuceHeader.h"
+#include "DSPKernels.h"
+#include "MirroredRingBuffer.h"
+
+namespace EchoSphere
+{
+    // Granular pitch shifter that reads straight out of a delay line's ring buffer.
+    //
+    // Kernels::maxGrains Hann-windowed grains overlap, a new one starting every
+    // grainLength / maxGrains samples. Each grain sweeps through the buffer at the pitch
+    // ratio, centred on the delay time halfway through its life, so the overlap-add is
+    // the delayed signal shifted in pitch. Grains are only started or retired between
+    // kernel calls, never per sample, and nothing allocates after prepare.
+    class GrainPitchShifter
+    {
+    public:
+        // Grain length; long enough for low notes, short enough not to smear transients
+        static constexpr double grainLengthMs = 60.0;
+
+        // sampleRate is the rate of the ring buffer it will read from
+        void prepare(double sampleRate, int maxBlockSize);
+        void reset() noexcept;
+
+        // Pitch shift in semitones; grains already playing keep their ratio
+        void setSemitones(float semitones) noexcept;
+
+        // Writes the shifted signal around centreDelay (in buffer samples) into output and
+        // returns how many samples that was: numSamples, or fewer if a grain starts sooner
+        // or a grain would reach samples that haven't been written yet. Call before writing
+        // the same span to the buffer. A centre too short for a grain's sweep (30 ms for an
+        // octave up) is pushed back to the shortest one that fits.
+        int process(const MirroredRingBuffer& buffer, float centreDelay, float* output, int numSamples) noexcept;
+
+    private:
+        // Start a grain in slot, already age samples into its life
+        void startGrain(int slot, int age, float centreDelay, int maxDelay) noexcept;
+
+        // Hann window, grainLength long, then zeros that idle slots read from
+        std::vector<float> window;
+        int grainLength = 0;
+        int hopSize = 0;
+        int samplesUntilNextGrain = 0;
+        float pitchRatio = 1.0f;
+        bool started = false;
+        juce::Random random;
+
+        // Per-slot state, laid out as the kernel's lane arrays. An age of grainLength
+        // (or more) marks the slot idle.
+        int grainAge[Kernels::maxGrains] = {};
+        float grainDelay[Kernels::maxGrains] = {};
+        float grainRate[Kernels::maxGrains] = {};
+        int windowOffset[Kernels::maxGrains] = {};
+        float sourceOffset[Kernels::maxGrains] = {};
+        float sourceRate[Kernels::maxGrains] = {};
+    };
+}
@@ -0,0 +1,241 @@
+#include "MirroredRingBuffer.h"
+
+#if JUCE_LINUX || JUCE_MAC || JUCE_BSD
+ #include <sys/mman.h>
+ #include <unistd.h>
+#endif
+
+namespace EchoSphere
+{
+    MirroredRingBuffer::MirroredRingBuffer()
+    {
+    }
+
+    MirroredRingBuffer::~MirroredRingBuffer()
+    {
+        releaseStorage();
+    }
+
+    MirroredRingBuffer::MirroredRingBuffer(MirroredRingBuffer&& other) noexcept
+    {
+        *this = std::move(other);
+    }
+
+    MirroredRingBuffer& MirroredRingBuffer::operator=(MirroredRingBuffer&& other) noexcept
+    {
+        if (this != &other)
+        {
+            std::swap(storage, other.storage);
+            std::swap(fallbackStorage, other.fallbackStorage);
+            std::swap(capacity, other.capacity);
+            std::swap(writePosition, other.writePosition);
+            std::swap(maximumDelay, other.maximumDelay);
+            std::swap(maximumBlockSize, other.maximumBlockSize);
+            std::swap(mirrored, other.mirrored);
+            std::swap(mirroringEnabled, other.mirroringEnabled);
+            std::swap(locked, other.locked);
+        }
+
+        return *this;
+    }
+
+    void MirroredRingBuffer::prepare(const juce::dsp::ProcessSpec& spec)
+    {
+        maximumBlockSize = juce::jmax(1, static_cast<int>(spec.maximumBlockSize));
+
+        // The block size is part of the capacity, so grow if a delay was already set
+        if (maximumDelay > 0 && maximumDelay + maximumBlockSize + 1 > capacity)
+            setMaximumDelayInSamples(maximumDelay);
+    }
+
+    void MirroredRingBuffer::setMaximumDelayInSamples(int maxDelayInSamples)
+    {
+        releaseStorage();
+        maximumDelay = juce::jmax(0, maxDelayInSamples);
+
+        if (maximumDelay == 0)
+            return;
+
+        // Room for the longest delay plus one block written ahead of the oldest read, so
+        // a block kernel's read and write windows never touch the same samples
+        const int numSamples = maximumDelay + maximumBlockSize + 1;
+
+        if (!mirroringEnabled || !allocateMirrored(numSamples))
+            allocateFallback(numSamples);
+
+        prefault();
+        reset();
+    }
+
+    void MirroredRingBuffer::reset()
+    {
+        writePosition = 0;
+
+        if (storage != nullptr)
+            juce::FloatVectorOperations::clear(storage, mirrored ? capacity : 2 * capacity);
+    }
+
+    float MirroredRingBuffer::popSample(int channel, float delayInSamples) const noexcept
+    {
+        juce::ignoreUnused(channel);
+
+        const int delayInt = static_cast<int>(delayInSamples);
+        const float fraction = delayInSamples - static_cast<float>(delayInt);
+
+        // older is one sample further back than the integer delay; the mirror makes older + 1 valid
+        const float* older = getReadPointer(delayInt + 1);
+        return older[1] + fraction * (older[0] - older[1]);
+    }
+
+    void MirroredRingBuffer::pushSample(int channel, float sample) noexcept
+    {
+        juce::ignoreUnused(channel);
+
+        storage[writePosition] = sample;
+
+        if (!mirrored)
+            storage[writePosition + capacity] = sample;
+
+        if (++writePosition == capacity)
+            writePosition = 0;
+    }
+
+    const float* MirroredRingBuffer::getReadPointer(int delayInSamples) const noexcept
+    {
+        int position = writePosition - delayInSamples;
+
+        if (position < 0)
+            position += capacity;
+
+        return storage + position;
+    }
+
+    void MirroredRingBuffer::advanceWritePosition(int numSamples) noexcept
+    {
+        if (!mirrored)
+        {
+            // Copy what was just written into the other half so both halves stay identical
+            const int inFirstHalf = juce::jmin(numSamples, capacity - writePosition);
+            juce::FloatVectorOperations::copy(storage + writePosition + capacity, storage + writePosition, inFirstHalf);
+
+            if (numSamples > inFirstHalf)
+                juce::FloatVectorOperations::copy(storage, storage + capacity, numSamples - inFirstHalf);
+        }
+
+        writePosition += numSamples;
+
+        if (writePosition >= capacity)
+            writePosition -= capacity;
+    }
+
+    void MirroredRingBuffer::prefault() noexcept
+    {
+        // Touch one value per page across the whole virtual range, including the mirror
+        // half, so the audio thread never takes the first fault on a fresh buffer
+        const int samplesPerPage = juce::jmax(1, juce::SystemStats::getPageSize() / static_cast<int>(sizeof(float)));
+        volatile float* pages = storage;
+
+        for (int i = 0; i < 2 * capacity; i += samplesPerPage)
+            pages[i] = 0.0f;
+    }
+
+    bool MirroredRingBuffer::lockMemory()
+    {
+        if (storage == nullptr)
+            return false;
+
+        if (locked)
+            return true;
+
+       #if JUCE_LINUX || JUCE_MAC || JUCE_BSD
+        // Both halves of the mirror share pages, so locking the first one pins everything.
+        // mlock applies RLIMIT_MEMLOCK itself, and lets CAP_IPC_LOCK processes past it.
+        locked = mlock(storage, static_cast<size_t>(mirrored ? capacity : 2 * capacity) * sizeof(float)) == 0;
+       #endif
+
+        return locked;
+    }
+
+    void MirroredRingBuffer::unlockMemory()
+    {
+       #if JUCE_LINUX || JUCE_MAC || JUCE_BSD
+        if (locked)
+            munlock(storage, static_cast<size_t>(mirrored ? capacity : 2 * capacity) * sizeof(float));
+       #endif
+
+        locked = false;
+    }
+
+    bool MirroredRingBuffer::allocateMirrored(int numSamples)
+    {
+       #if JUCE_LINUX && defined (MFD_CLOEXEC)
+        // The mapping granularity is a page, so round the buffer up to whole pages
+        const auto pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        const auto bytes = (static_cast<size_t>(numSamples) * sizeof(float) + pageSize - 1) / pageSize * pageSize;
+
+        const int fd = memfd_create("echosphere-delay", MFD_CLOEXEC);
+
+        if (fd < 0)
+            return false;
+
+        if (ftruncate(fd, static_cast<off_t>(bytes)) != 0)
+        {
+            close(fd);
+            return false;
+        }
+
+        // Reserve one contiguous range, then map the same file over both halves of it
+        auto* reserved = static_cast<char*>(mmap(nullptr, 2 * bytes, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+
+        if (reserved == MAP_FAILED)
+        {
+            close(fd);
+            return false;
+        }
+
+        const bool mapped = mmap(reserved, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) != MAP_FAILED
+                         && mmap(reserved + bytes, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) != MAP_FAILED;
+
+        // The mappings keep the memory alive
+        close(fd);
+
+        if (!mapped)
+        {
+            munmap(reserved, 2 * bytes);
+            return false;
+        }
+
+        storage = reinterpret_cast<float*>(reserved);
+        capacity = static_cast<int>(bytes / sizeof(float));
+        mirrored = true;
+        return true;
+       #else
+        juce::ignoreUnused(numSamples);
+        return false;
+       #endif
+    }
+
+    void MirroredRingBuffer::allocateFallback(int numSamples)
+    {
+        fallbackStorage.allocate(static_cast<size_t>(2 * numSamples), true);
+        storage = fallbackStorage.get();
+        capacity = numSamples;
+        mirrored = false;
+    }
+
+    void MirroredRingBuffer::releaseStorage()
+    {
+        unlockMemory();
+
+       #if JUCE_LINUX
+        if (mirrored && storage != nullptr)
+            munmap(storage, 2 * static_cast<size_t>(capacity) * sizeof(float));
+       #endif
+
+        fallbackStorage.free();
+        storage = nullptr;
+        capacity = 0;
+        writePosition = 0;
+        mirrored = false;
+    }
+}
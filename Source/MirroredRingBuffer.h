@@ -0,0 +1,82 @@
+#pragma once
+
+#include "JuceHeader.h"
+
+namespace EchoSphere
+{
+    // Single-channel delay buffer whose storage is mapped twice, back to back, in
+    // virtual memory. Any window of up to getCapacity() samples starting inside the
+    // buffer is contiguous, so block kernels can read and write with plain linear
+    // loops and never split at the wrap point.
+    //
+    // On Linux the mirror is a memfd mapped twice over one reserved range. Elsewhere
+    // (or if mapping fails) a plain allocation of twice the size is used and writes
+    // are copied into the second half, which keeps the same contiguity guarantee.
+    //
+    // The per-sample interface matches the subset of juce::dsp::DelayLine (linear
+    // interpolation, one channel) that DelayLine uses.
+    class MirroredRingBuffer
+    {
+    public:
+        MirroredRingBuffer();
+        ~MirroredRingBuffer();
+
+        MirroredRingBuffer(MirroredRingBuffer&& other) noexcept;
+        MirroredRingBuffer& operator=(MirroredRingBuffer&& other) noexcept;
+
+        // Sets the largest block that will be read or written in one go
+        void prepare(const juce::dsp::ProcessSpec& spec);
+
+        // Reallocates the buffer and faults in every page of it (not on the audio thread)
+        void setMaximumDelayInSamples(int maxDelayInSamples);
+        int getMaximumDelayInSamples() const noexcept { return maximumDelay; }
+
+        void reset();
+
+        // Per-sample access, same semantics as juce::dsp::DelayLine: pop before push
+        float popSample(int channel, float delayInSamples) const noexcept;
+        void pushSample(int channel, float sample) noexcept;
+
+        // Block access. The window starting delayInSamples before the write position is
+        // contiguous for up to getCapacity() samples, as is the write window.
+        const float* getReadPointer(int delayInSamples) const noexcept;
+        float* getWritePointer() noexcept { return storage + writePosition; }
+
+        // Commit numSamples written through getWritePointer() (at most the block size)
+        void advanceWritePosition(int numSamples) noexcept;
+
+        int getCapacity() const noexcept { return capacity; }
+        int getMaximumBlockSize() const noexcept { return maximumBlockSize; }
+
+        // True when the double mapping is in use rather than the copying fallback
+        bool isMirrored() const noexcept { return mirrored; }
+
+        // Use the copying fallback even where the double mapping is available, so the two
+        // can be compared. Takes effect at the next setMaximumDelayInSamples().
+        void setMirroringEnabled(bool shouldMirror) noexcept { mirroringEnabled = shouldMirror; }
+
+        // Pin the storage in physical memory. Returns false (and leaves the buffer usable,
+        // just pageable) if the platform or RLIMIT_MEMLOCK doesn't allow it.
+        bool lockMemory();
+        bool isMemoryLocked() const noexcept { return locked; }
+
+    private:
+        bool allocateMirrored(int numSamples);
+        void allocateFallback(int numSamples);
+        void releaseStorage();
+        void prefault() noexcept;
+        void unlockMemory();
+
+        float* storage = nullptr;
+        juce::HeapBlock<float> fallbackStorage;
+        int capacity = 0;
+        int writePosition = 0;
+        int maximumDelay = 0;
+        int maximumBlockSize = 512;
+        bool mirrored = false;
+        bool mirroringEnabled = true;
+        bool locked = false;
+
+        JUCE_DECLARE_NON_COPYABLE(MirroredRingBuffer)
+    };
+}
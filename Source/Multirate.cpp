@@ -0,0 +1,258 @@
+#include "Multirate.h"
+
+namespace EchoSphere
+{
+    namespace
+    {
+        // Zeroth-order modified Bessel function, for the Kaiser window
+        double besselI0(double x)
+        {
+            double sum = 1.0;
+            double term = 1.0;
+
+            for (int k = 1; k < 50; ++k)
+            {
+                term *= (x / (2.0 * k)) * (x / (2.0 * k));
+                sum += term;
+
+                if (term < sum * 1.0e-12)
+                    break;
+            }
+
+            return sum;
+        }
+    }
+
+    HalfbandDesign HalfbandDesign::create(double inputRate, double passbandEdgeHz)
+    {
+        // Stopband attenuation; aliases land at least this far down
+        constexpr double attenuationDb = 100.0;
+        constexpr int maxOddTaps = 64;
+
+        const double passband = juce::jmin(passbandEdgeHz, 0.9 * inputRate / 4.0);
+        const double transition = 2.0 * juce::MathConstants<double>::pi * (inputRate / 2.0 - 2.0 * passband) / inputRate;
+
+        // Kaiser's length estimate, rounded up to a halfband length (4 * taps - 1)
+        const double length = (attenuationDb - 7.95) / (2.285 * transition) + 1.0;
+        const int numOddTaps = juce::jlimit(2, maxOddTaps, static_cast<int>(std::ceil((length + 1.0) / 4.0)));
+
+        HalfbandDesign design;
+        design.oddTaps.resize(static_cast<size_t>(numOddTaps));
+
+        const double beta = 0.1102 * (attenuationDb - 8.7);
+        const double centre = design.getCentre();
+        double sum = 0.0;
+
+        for (int k = 0; k < numOddTaps; ++k)
+        {
+            const double offset = 2 * k + 1;
+            const double ideal = std::sin(juce::MathConstants<double>::halfPi * offset) / (juce::MathConstants<double>::pi * offset);
+            const double ratio = offset / centre;
+            const double window = besselI0(beta * std::sqrt(juce::jmax(0.0, 1.0 - ratio * ratio))) / besselI0(beta);
+
+            design.oddTaps[static_cast<size_t>(k)] = static_cast<float>(ideal * window);
+            sum += ideal * window;
+        }
+
+        // Unity gain at DC: centre (0.5) plus both sides of the odd taps
+        for (auto& tap : design.oddTaps)
+            tap = static_cast<float>(tap * 0.25 / sum);
+
+        return design;
+    }
+
+    //==============================================================================
+    void HalfbandDecimator::prepare(const HalfbandDesign& design, int maxInputSamples)
+    {
+        oddTaps = design.oddTaps;
+        centre = design.getCentre();
+
+        // History of length - 1 samples, an odd leftover and a full block
+        buffer.assign(static_cast<size_t>(design.getLength() + maxInputSamples), 0.0f);
+        reset();
+    }
+
+    void HalfbandDecimator::reset()
+    {
+        std::fill(buffer.begin(), buffer.end(), 0.0f);
+        numBuffered = 2 * centre;
+    }
+
+    int HalfbandDecimator::process(const float* input, int numInput, float* output) noexcept
+    {
+        std::copy(input, input + numInput, buffer.data() + numBuffered);
+        numBuffered += numInput;
+
+        // Output m is centred on buffer[2m + centre]; only the odd-offset taps are non-zero
+        const int numOutput = (numBuffered - 2 * centre) / 2;
+        const int numOddTaps = static_cast<int>(oddTaps.size());
+        const float* taps = oddTaps.data();
+
+        for (int m = 0; m < numOutput; ++m)
+        {
+            const float* middle = buffer.data() + 2 * m + centre;
+            float sum = 0.5f * middle[0];
+
+            for (int k = 0; k < numOddTaps; ++k)
+                sum += taps[k] * (middle[2 * k + 1] + middle[-(2 * k + 1)]);
+
+            output[m] = sum;
+        }
+
+        // Keep the history (and any odd sample) for the next call
+        const int consumed = 2 * numOutput;
+        std::copy(buffer.begin() + consumed, buffer.begin() + numBuffered, buffer.begin());
+        numBuffered -= consumed;
+
+        return numOutput;
+    }
+
+    //==============================================================================
+    void HalfbandInterpolator::prepare(const HalfbandDesign& design, int maxInputSamples)
+    {
+        oddTaps = design.oddTaps;
+
+        // Input m needs inputs back to m - (2 * numOddTaps - 1)
+        historySize = 2 * static_cast<int>(oddTaps.size()) - 1;
+        buffer.assign(static_cast<size_t>(historySize + maxInputSamples), 0.0f);
+        reset();
+    }
+
+    void HalfbandInterpolator::reset()
+    {
+        std::fill(buffer.begin(), buffer.end(), 0.0f);
+    }
+
+    void HalfbandInterpolator::process(const float* input, int numInput, float* output) noexcept
+    {
+        std::copy(input, input + numInput, buffer.data() + historySize);
+
+        const int numOddTaps = static_cast<int>(oddTaps.size());
+        const float* taps = oddTaps.data();
+
+        for (int m = 0; m < numInput; ++m)
+        {
+            const float* current = buffer.data() + historySize + m;
+
+            // Even outputs come from the odd-tap phase (doubled to make up for the
+            // zero stuffing); odd outputs are the centre tap alone, a delayed copy
+            float sum = 0.0f;
+
+            for (int k = 0; k < numOddTaps; ++k)
+                sum += taps[k] * (current[-(numOddTaps - 1 - k)] + current[-(numOddTaps + k)]);
+
+            output[2 * m] = 2.0f * sum;
+            output[2 * m + 1] = current[-(numOddTaps - 1)];
+        }
+
+        std::copy(buffer.begin() + numInput, buffer.begin() + numInput + historySize, buffer.begin());
+    }
+
+    //==============================================================================
+    void WetPathResampler::prepare(double sampleRate, int newDivisor, int maxBlockSize)
+    {
+        divisor = newDivisor >= 4 ? 4 : (newDivisor >= 2 ? 2 : 1);
+        numStages = divisor == 4 ? 2 : (divisor == 2 ? 1 : 0);
+        maxLowRateBlock = maxBlockSize / divisor + 1;
+
+        // Stage s runs from sampleRate / 2^s down to half that. Going down and back up
+        // through it delays by 2 * centre of its input samples, which is 2^(s+1) * centre
+        // at the host rate. The FIFO's pre-roll adds divisor - 1 on top.
+        latency = divisor - 1;
+        double stageRate = sampleRate;
+
+        for (int stage = 0; stage < numStages; ++stage)
+        {
+            const auto design = HalfbandDesign::create(stageRate, passbandEdgeHz);
+            const int stageInput = maxBlockSize / (1 << stage) + 2;
+
+            decimators[stage].prepare(design, stageInput);
+            interpolators[stage].prepare(design, stageInput / 2 + 1);
+            latency += (2 << stage) * design.getCentre();
+
+            stageRate /= 2.0;
+        }
+
+        stageBuffer.assign(static_cast<size_t>(maxBlockSize / 2 + 2), 0.0f);
+        fifo.assign(static_cast<size_t>(divisor * maxLowRateBlock + 2 * divisor), 0.0f);
+        reset();
+    }
+
+    void WetPathResampler::reset()
+    {
+        for (int stage = 0; stage < numStages; ++stage)
+        {
+            decimators[stage].reset();
+            interpolators[stage].reset();
+        }
+
+        // Pre-roll so pull never runs ahead of what upsample has produced
+        std::fill(fifo.begin(), fifo.end(), 0.0f);
+        fifoCount = divisor - 1;
+    }
+
+    int WetPathResampler::downsample(const float* input, int numSamples, float* output) noexcept
+    {
+        switch (numStages)
+        {
+            case 1:
+                return decimators[0].process(input, numSamples, output);
+
+            case 2:
+            {
+                const int numHalf = decimators[0].process(input, numSamples, stageBuffer.data());
+                return decimators[1].process(stageBuffer.data(), numHalf, output);
+            }
+
+            default:
+                std::copy(input, input + numSamples, output);
+                return numSamples;
+        }
+    }
+
+    void WetPathResampler::upsample(const float* input, int numSamples) noexcept
+    {
+        float* destination = fifo.data() + fifoCount;
+
+        switch (numStages)
+        {
+            case 1:
+                interpolators[0].process(input, numSamples, destination);
+                break;
+
+            case 2:
+                interpolators[1].process(input, numSamples, stageBuffer.data());
+                interpolators[0].process(stageBuffer.data(), 2 * numSamples, destination);
+                break;
+
+            default:
+                std::copy(input, input + numSamples, destination);
+                break;
+        }
+
+        fifoCount += divisor * numSamples;
+    }
+
+    void WetPathResampler::pull(float* output, int numSamples) noexcept
+    {
+        jassert(numSamples <= fifoCount);
+        numSamples = juce::jmin(numSamples, fifoCount);
+
+        std::copy(fifo.begin(), fifo.begin() + numSamples, output);
+        std::copy(fifo.begin() + numSamples, fifo.begin() + fifoCount, fifo.begin());
+        fifoCount -= numSamples;
+    }
+
+    int WetPathResampler::getAutomaticDivisor(double sampleRate) noexcept
+    {
+        constexpr double lowestWetRate = 44100.0;
+
+        if (sampleRate / 4.0 >= lowestWetRate)
+            return 4;
+
+        if (sampleRate / 2.0 >= lowestWetRate)
+            return 2;
+
+        return 1;
+    }
+}
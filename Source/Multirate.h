@@ -0,0 +1,102 @@
+#pragma once
+
+#include "JuceHeader.h"
+
+namespace EchoSphere
+{
+    // Linear-phase halfband lowpass for 2:1 rate changes. Every even tap away from the
+    // centre is zero and the centre tap is 0.5, so only the odd taps are stored.
+    struct HalfbandDesign
+    {
+        // Kaiser-windowed design cutting at a quarter of inputRate, with the passband
+        // running up to passbandEdgeHz
+        static HalfbandDesign create(double inputRate, double passbandEdgeHz);
+
+        // Odd taps at offsets 1, 3, 5... from the centre (the filter is symmetric)
+        std::vector<float> oddTaps;
+
+        // Centre tap index, which is also the group delay in input samples
+        int getCentre() const noexcept { return 2 * static_cast<int>(oddTaps.size()) - 1; }
+        int getLength() const noexcept { return 2 * getCentre() + 1; }
+    };
+
+    // Streaming 2:1 polyphase decimator. Accepts any number of input samples per call and
+    // keeps an odd one over for the next call.
+    class HalfbandDecimator
+    {
+    public:
+        void prepare(const HalfbandDesign& design, int maxInputSamples);
+        void reset();
+
+        // Returns the number of samples written to output (numInput / 2, give or take one)
+        int process(const float* input, int numInput, float* output) noexcept;
+
+    private:
+        std::vector<float> oddTaps;
+        std::vector<float> buffer;
+        int centre = 0;
+        int numBuffered = 0;
+    };
+
+    // Streaming 1:2 polyphase interpolator: two output samples per input sample
+    class HalfbandInterpolator
+    {
+    public:
+        void prepare(const HalfbandDesign& design, int maxInputSamples);
+        void reset();
+
+        void process(const float* input, int numInput, float* output) noexcept;
+
+    private:
+        std::vector<float> oddTaps;
+        std::vector<float> buffer;
+        int historySize = 0;
+    };
+
+    // Takes the delay's wet path down to 1/2 or 1/4 of the host rate and back up again,
+    // through one halfband stage per octave. Output comes out of a small FIFO so any
+    // host block size works, including sizes that don't divide by the rate divisor.
+    class WetPathResampler
+    {
+    public:
+        // Passband kept intact by each stage (or 90% of its output Nyquist, if lower)
+        static constexpr double passbandEdgeHz = 20000.0;
+
+        // divisor is 1, 2 or 4; 1 makes every call a plain copy
+        void prepare(double sampleRate, int divisor, int maxBlockSize);
+        void reset();
+
+        int getDivisor() const noexcept { return divisor; }
+
+        // Most low-rate samples one downsample call can produce
+        int getMaxLowRateBlockSize() const noexcept { return maxLowRateBlock; }
+
+        // Delay through downsample, upsample and pull, in host-rate samples
+        int getLatencyInSamples() const noexcept { return latency; }
+
+        // Host rate to low rate; returns how many low-rate samples were written
+        int downsample(const float* input, int numSamples, float* output) noexcept;
+
+        // Low rate back to host rate, queued for pull
+        void upsample(const float* input, int numSamples) noexcept;
+
+        // Take numSamples host-rate samples from the queue
+        void pull(float* output, int numSamples) noexcept;
+
+        // Highest divisor (1, 2 or 4) whose rate stays at or above 44.1 kHz
+        static int getAutomaticDivisor(double sampleRate) noexcept;
+
+    private:
+        int divisor = 1;
+        int numStages = 0;
+        int maxLowRateBlock = 0;
+        int latency = 0;
+
+        HalfbandDecimator decimators[2];
+        HalfbandInterpolator interpolators[2];
+        std::vector<float> stageBuffer;
+
+        std::vector<float> fifo;
+        int fifoCount = 0;
+    };
+}
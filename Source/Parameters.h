@@ -4,26 +4,222 @@
 
 namespace EchoSphere
 {
+    // Dense parameter indices. The order is the binary state layout, so only ever
+    // append new parameters (before NUM_PARAMETERS).
+    namespace ParamIndex
+    {
+        enum Index : int
+        {
+            DELAY_TIME = 0,
+            FEEDBACK,
+            MIX,
+            SYNC,
+            SYNC_NOTE,
+            STEREO_MODE,
+            SIDE_DELAY_TIME,
+            SIDE_FEEDBACK,
+            REVERB_MIX,
+            WET_PATH_RATE,
+            PITCH_SHIFT,
+            SHIMMER,
+            FREEZE,
+            REVERSE,
+            NUM_PARAMETERS
+        };
+    }
+    
+    enum class ParamType
+    {
+        Float,
+        Toggle,
+        Choice
+    };
+    
+    // Display formatters referenced by the descriptor table
+    namespace ParamText
+    {
+        inline juce::String percentToText(float value, int)
+        {
+            return juce::String(value, 1) + "%";
+        }
+        
+        inline float textToPercent(const juce::String& text)
+        {
+            return text.getFloatValue();
+        }
+        
+        // Delay time display: samples for micro-delays, otherwise ms with range-dependent precision
+        inline juce::String delayTimeToText(float value, int)
+        {
+            // Custom formatting based on value range
+            if (value < 0.1f) {
+                // For extremely small values, show samples (assuming 44.1kHz)
+                int samples = static_cast<int>(value * 44.1f); // Approximate samples at 44.1kHz
+                return juce::String(samples) + " samples";
+            }
+            else if (value < 1.0f)
+                return juce::String(value, 2) + " ms"; 
+            else if (value < 10.0f)
+                return juce::String(value, 1) + " ms";
+            else
+                return juce::String(int(value)) + " ms";
+        }
+        
+        inline float textToDelayTime(const juce::String& text)
+        {
+            // Handle both ms and samples input
+            if (text.containsIgnoreCase("sample"))
+                return text.getFloatValue() / 44.1f; // Convert samples back to ms
+            return text.getFloatValue(); 
+        }
+        
+        inline juce::String semitonesToText(float value, int)
+        {
+            return (value > 0.0f ? "+" : "") + juce::String(value, 2) + " st";
+        }
+        
+        inline float textToSemitones(const juce::String& text)
+        {
+            return text.getFloatValue();
+        }
+    }
+    
+    // Choice lists, in choice index order
+    inline constexpr const char* syncNoteNames[] = {
+        "1/1", "1/2", "1/4", "1/8", "1/16", "1/32", "1/64", 
+        "1/2D", "1/4D", "1/8D", "1/16D", 
+        "1/2T", "1/4T", "1/8T", "1/16T" 
+    };
+    
+    inline constexpr const char* stereoModeNames[] = { "Stereo", "Mid/Side" };
+    
+    // Auto picks the lowest rate that is still at least 44.1 kHz
+    inline constexpr const char* wetPathRateNames[] = { "Auto", "Full", "Half", "Quarter" };
+    
+    // Everything needed to create, display, bind and serialise one parameter
+    struct ParamDescriptor
+    {
+        ParamIndex::Index index;
+        const char* id;
+        const char* name;
+        ParamType type;
+        float minValue;
+        float maxValue;
+        float interval;
+        float skew;
+        float defaultValue;                      // Choice index for choices, 0 or 1 for toggles
+        const char* const* choices;
+        int numChoices;
+        juce::String (*valueToText)(float, int); // nullptr for JUCE's default formatting
+        float (*textToValue)(const juce::String&);
+    };
+    
+    // The single source of truth for every parameter
+    inline constexpr ParamDescriptor parameterDescriptors[] = {
+        // Delay Time: From 2 samples up to 2000ms with logarithmic scaling for fine control
+        // (0.045ms = ~2 samples at 44.1kHz)
+        { ParamIndex::DELAY_TIME, "delay_time", "Delay Time", ParamType::Float, 0.045f, 2000.0f, 0.001f, 0.15f, 200.0f,
+          nullptr, 0, ParamText::delayTimeToText, ParamText::textToDelayTime },
+        
+        // Feedback: 0% to 100%
+        { ParamIndex::FEEDBACK, "feedback", "Feedback", ParamType::Float, 0.0f, 100.0f, 0.1f, 1.0f, 30.0f,
+          nullptr, 0, ParamText::percentToText, ParamText::textToPercent },
+        
+        // Mix: 0% to 100%
+        { ParamIndex::MIX, "mix", "Mix", ParamType::Float, 0.0f, 100.0f, 0.1f, 1.0f, 50.0f,
+          nullptr, 0, ParamText::percentToText, ParamText::textToPercent },
+        
+        // Sync Toggle
+        { ParamIndex::SYNC, "sync", "Sync", ParamType::Toggle, 0.0f, 1.0f, 1.0f, 1.0f, 0.0f,
+          nullptr, 0, nullptr, nullptr },
+        
+        // Sync Note - Quarter note default (index 2)
+        { ParamIndex::SYNC_NOTE, "sync_note", "Sync Note", ParamType::Choice, 0.0f, 14.0f, 1.0f, 1.0f, 2.0f,
+          syncNoteNames, static_cast<int>(std::size(syncNoteNames)), nullptr, nullptr },
+        
+        // Stereo Mode: linked stereo or mid/side
+        { ParamIndex::STEREO_MODE, "stereo_mode", "Stereo Mode", ParamType::Choice, 0.0f, 1.0f, 1.0f, 1.0f, 0.0f,
+          stereoModeNames, static_cast<int>(std::size(stereoModeNames)), nullptr, nullptr },
+        
+        // Side Delay Time: delay for the side channel in mid/side mode (mid uses Delay Time)
+        { ParamIndex::SIDE_DELAY_TIME, "side_delay_time", "Side Delay Time", ParamType::Float, 0.045f, 2000.0f, 0.001f, 0.15f, 200.0f,
+          nullptr, 0, ParamText::delayTimeToText, ParamText::textToDelayTime },
+        
+        // Side Feedback: feedback for the side channel in mid/side mode
+        { ParamIndex::SIDE_FEEDBACK, "side_feedback", "Side Feedback", ParamType::Float, 0.0f, 100.0f, 0.1f, 1.0f, 30.0f,
+          nullptr, 0, ParamText::percentToText, ParamText::textToPercent },
+        
+        // Reverb Mix: 0% (off) to 100%
+        { ParamIndex::REVERB_MIX, "reverb_mix", "Reverb Mix", ParamType::Float, 0.0f, 100.0f, 0.1f, 1.0f, 0.0f,
+          nullptr, 0, ParamText::percentToText, ParamText::textToPercent },
+        
+        // Wet Path Rate: rate the delay's feedback loop runs at, relative to the host. Full by
+        // default, so sessions from before the parameter existed sound the same.
+        { ParamIndex::WET_PATH_RATE, "wet_path_rate", "Wet Path Rate", ParamType::Choice, 0.0f, 3.0f, 1.0f, 1.0f, 1.0f,
+          wetPathRateNames, static_cast<int>(std::size(wetPathRateNames)), nullptr, nullptr },
+        
+        // Pitch Shift: interval the shimmer shifts each repeat by, up to two octaves either way
+        { ParamIndex::PITCH_SHIFT, "pitch_shift", "Pitch Shift", ParamType::Float, -24.0f, 24.0f, 0.01f, 1.0f, 12.0f,
+          nullptr, 0, ParamText::semitonesToText, ParamText::textToSemitones },
+        
+        // Shimmer: share of the feedback sent through the pitch shifter, 0% (off) to 100%
+        { ParamIndex::SHIMMER, "shimmer", "Shimmer", ParamType::Float, 0.0f, 100.0f, 0.1f, 1.0f, 0.0f,
+          nullptr, 0, ParamText::percentToText, ParamText::textToPercent },
+        
+        // Freeze: hold the last delay time's worth of audio and loop it
+        { ParamIndex::FREEZE, "freeze", "Freeze", ParamType::Toggle, 0.0f, 1.0f, 1.0f, 1.0f, 0.0f,
+          nullptr, 0, nullptr, nullptr },
+        
+        // Reverse: play each delay-time-long chunk backwards
+        { ParamIndex::REVERSE, "reverse", "Reverse", ParamType::Toggle, 0.0f, 1.0f, 1.0f, 1.0f, 0.0f,
+          nullptr, 0, nullptr, nullptr }
+    };
+    
+    // The table must list every index exactly once, in order
+    constexpr bool parameterDescriptorsAreInIndexOrder()
+    {
+        for (int i = 0; i < static_cast<int>(std::size(parameterDescriptors)); ++i)
+            if (parameterDescriptors[i].index != i)
+                return false;
+        
+        return std::size(parameterDescriptors) == ParamIndex::NUM_PARAMETERS;
+    }
+    
+    static_assert(parameterDescriptorsAreInIndexOrder(), "parameterDescriptors must match ParamIndex");
+    
+    constexpr const ParamDescriptor& getParamDescriptor(ParamIndex::Index index)
+    {
+        return parameterDescriptors[index];
+    }
+    
     // Parameter IDs - used to identify and access parameters
     namespace ParamIDs
     {
         // Main parameters (Phase 1)
-        inline const juce::String DELAY_TIME  = "delay_time";
-        inline const juce::String FEEDBACK    = "feedback";
-        inline const juce::String MIX         = "mix";
-        inline const juce::String SYNC        = "sync";
-        inline const juce::String SYNC_NOTE   = "sync_note";
+        inline const juce::String DELAY_TIME  = getParamDescriptor(ParamIndex::DELAY_TIME).id;
+        inline const juce::String FEEDBACK    = getParamDescriptor(ParamIndex::FEEDBACK).id;
+        inline const juce::String MIX         = getParamDescriptor(ParamIndex::MIX).id;
+        inline const juce::String SYNC        = getParamDescriptor(ParamIndex::SYNC).id;
+        inline const juce::String SYNC_NOTE   = getParamDescriptor(ParamIndex::SYNC_NOTE).id;
         
         // Additional parameters (future phases)
         inline const juce::String FILTER_FREQ_LP = "filter_freq_lp";
         inline const juce::String FILTER_FREQ_HP = "filter_freq_hp";
         inline const juce::String SATURATION     = "saturation";
-        inline const juce::String STEREO_MODE    = "stereo_mode";
+        inline const juce::String STEREO_MODE    = getParamDescriptor(ParamIndex::STEREO_MODE).id;
         inline const juce::String LFO_RATE       = "lfo_rate";
         inline const juce::String LFO_DEPTH      = "lfo_depth";
         inline const juce::String LFO_WAVEFORM   = "lfo_waveform";
         inline const juce::String LFO_SYNC       = "lfo_sync";
         inline const juce::String LFO_DEST       = "lfo_destination";
+        inline const juce::String REVERB_MIX     = getParamDescriptor(ParamIndex::REVERB_MIX).id;
+        inline const juce::String SIDE_DELAY_TIME = getParamDescriptor(ParamIndex::SIDE_DELAY_TIME).id;
+        inline const juce::String SIDE_FEEDBACK   = getParamDescriptor(ParamIndex::SIDE_FEEDBACK).id;
+        inline const juce::String WET_PATH_RATE   = getParamDescriptor(ParamIndex::WET_PATH_RATE).id;
+        inline const juce::String PITCH_SHIFT     = getParamDescriptor(ParamIndex::PITCH_SHIFT).id;
+        inline const juce::String SHIMMER         = getParamDescriptor(ParamIndex::SHIMMER).id;
+        inline const juce::String FREEZE          = getParamDescriptor(ParamIndex::FREEZE).id;
+        inline const juce::String REVERSE         = getParamDescriptor(ParamIndex::REVERSE).id;
     }
 
     // Sync note values
@@ -52,9 +248,13 @@ namespace EchoSphere
         MONO = 1,
         LINKED_STEREO = 2,
         PING_PONG = 3,
-        DUAL_DELAY = 4
+        DUAL_DELAY = 4,
+        MID_SIDE = 5
     };
     
+    // Stereo modes offered by the STEREO_MODE parameter, in choice index order
+    inline constexpr StereoMode stereoModeChoices[] = { LINKED_STEREO, MID_SIDE };
+    
     // LFO Waveforms
     enum LfoWaveform
     {
@@ -70,87 +270,58 @@ namespace EchoSphere
     class Parameters
     {
     public:
-        // Create the parameter layout used by the processor
+        // Create the parameter layout used by the processor, one parameter per descriptor
         static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout()
         {
             juce::AudioProcessorValueTreeState::ParameterLayout layout;
             
-            // Delay Time: From 2 samples up to 2000ms with logarithmic scaling for fine control
-            layout.add(std::make_unique<juce::AudioParameterFloat>(
-                ParamIDs::DELAY_TIME,
-                "Delay Time",
-                juce::NormalisableRange<float>(0.045f, 2000.0f, 0.001f, 0.15f), // 0.045ms = ~2 samples at 44.1kHz
-                200.0f,
-                juce::String(),
-                juce::AudioProcessorParameter::genericParameter,
-                [](float value, int) { 
-                    // Custom formatting based on value range
-                    if (value < 0.1f) {
-                        // For extremely small values, show samples (assuming 44.1kHz)
-                        int samples = static_cast<int>(value * 44.1f); // Approximate samples at 44.1kHz
-                        return juce::String(samples) + " samples";
-                    }
-                    else if (value < 1.0f)
-                        return juce::String(value, 2) + " ms"; 
-                    else if (value < 10.0f)
-                        return juce::String(value, 1) + " ms";
-                    else
-                        return juce::String(int(value)) + " ms";
-                },
-                [](const juce::String& text) { 
-                    // Handle both ms and samples input
-                    if (text.containsIgnoreCase("sample"))
-                        return text.getFloatValue() / 44.1f; // Convert samples back to ms
-                    return text.getFloatValue(); 
-                }
-            ));
-            
-            // Feedback: 0% to 100%
-            layout.add(std::make_unique<juce::AudioParameterFloat>(
-                ParamIDs::FEEDBACK,
-                "Feedback",
-                juce::NormalisableRange<float>(0.0f, 100.0f, 0.1f),
-                30.0f,
-                juce::String(),
-                juce::AudioProcessorParameter::genericParameter,
-                [](float value, int) { return juce::String(value, 1) + "%"; },
-                [](const juce::String& text) { return text.getFloatValue(); }
-            ));
-            
-            // Mix: 0% to 100%
-            layout.add(std::make_unique<juce::AudioParameterFloat>(
-                ParamIDs::MIX,
-                "Mix",
-                juce::NormalisableRange<float>(0.0f, 100.0f, 0.1f),
-                50.0f,
-                juce::String(),
-                juce::AudioProcessorParameter::genericParameter,
-                [](float value, int) { return juce::String(value, 1) + "%"; },
-                [](const juce::String& text) { return text.getFloatValue(); }
-            ));
-            
-            // Sync Toggle
-            layout.add(std::make_unique<juce::AudioParameterBool>(
-                ParamIDs::SYNC,
-                "Sync",
-                false
-            ));
-            
-            // Sync Note - Quarter note default (Enum parameter)
-            juce::StringArray syncNoteNames = { 
-                "1/1", "1/2", "1/4", "1/8", "1/16", "1/32", "1/64", 
-                "1/2D", "1/4D", "1/8D", "1/16D", 
-                "1/2T", "1/4T", "1/8T", "1/16T" 
-            };
-            
-            layout.add(std::make_unique<juce::AudioParameterChoice>(
-                ParamIDs::SYNC_NOTE,
-                "Sync Note",
-                syncNoteNames,
-                2  // Default to quarter note (index 2)
-            ));
+            for (const auto& descriptor : parameterDescriptors)
+                layout.add(createParameter(descriptor));
             
             return layout;
         }
+        
+        // Choice names for a choice parameter (empty for anything else)
+        static juce::StringArray getChoiceNames(ParamIndex::Index index)
+        {
+            const auto& descriptor = getParamDescriptor(index);
+            return juce::StringArray(descriptor.choices, descriptor.numChoices);
+        }
+        
+    private:
+        static std::unique_ptr<juce::RangedAudioParameter> createParameter(const ParamDescriptor& descriptor)
+        {
+            switch (descriptor.type)
+            {
+                case ParamType::Toggle:
+                    return std::make_unique<juce::AudioParameterBool>(
+                        descriptor.id,
+                        descriptor.name,
+                        descriptor.defaultValue > 0.5f
+                    );
+                    
+                case ParamType::Choice:
+                    return std::make_unique<juce::AudioParameterChoice>(
+                        descriptor.id,
+                        descriptor.name,
+                        juce::StringArray(descriptor.choices, descriptor.numChoices),
+                        static_cast<int>(descriptor.defaultValue)
+                    );
+                    
+                case ParamType::Float:
+                default:
+                    return std::make_unique<juce::AudioParameterFloat>(
+                        descriptor.id,
+                        descriptor.name,
+                        juce::NormalisableRange<float>(descriptor.minValue, descriptor.maxValue,
+                                                       descriptor.interval, descriptor.skew),
+                        descriptor.defaultValue,
+                        juce::String(),
+                        juce::AudioProcessorParameter::genericParameter,
+                        descriptor.valueToText,
+                        descriptor.textToValue
+                    );
+            }
+        }
     };
-} 
\ No newline at end of file
+}
\ No newline at end of file
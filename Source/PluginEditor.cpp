@@ -9,25 +9,29 @@ namespace EchoSphere
         // Setup UI components and properties
         setupUIComponents();
         
-        // Create parameter attachments
+        // Create parameter attachments, bound through the descriptor table
         auto& parameters = processorRef.getParameterTree();
         delayTimeAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
-            parameters, ParamIDs::DELAY_TIME, delayTimeSlider);
+            parameters, getParamDescriptor(ParamIndex::DELAY_TIME).id, delayTimeSlider);
             
         feedbackAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
-            parameters, ParamIDs::FEEDBACK, feedbackSlider);
+            parameters, getParamDescriptor(ParamIndex::FEEDBACK).id, feedbackSlider);
             
         mixAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
-            parameters, ParamIDs::MIX, mixSlider);
+            parameters, getParamDescriptor(ParamIndex::MIX).id, mixSlider);
             
         syncAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(
-            parameters, ParamIDs::SYNC, syncToggle);
+            parameters, getParamDescriptor(ParamIndex::SYNC).id, syncToggle);
             
         syncNoteAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
-            parameters, ParamIDs::SYNC_NOTE, syncNoteCombo);
+            parameters, getParamDescriptor(ParamIndex::SYNC_NOTE).id, syncNoteCombo);
         
         // Set editor size
         setSize(450, 300);
+        
+       #if ECHOSPHERE_PROFILER
+        startTimerHz(4);
+       #endif
     }
 
     EchoSphereAudioProcessorEditor::~EchoSphereAudioProcessorEditor()
@@ -44,7 +48,7 @@ namespace EchoSphere
         delayTimeSlider.setColour(juce::Slider::textBoxBackgroundColourId, juce::Colours::darkgrey);
         addAndMakeVisible(delayTimeSlider);
         
-        delayTimeLabel.setText("Delay Time", juce::dontSendNotification);
+        delayTimeLabel.setText(getParamDescriptor(ParamIndex::DELAY_TIME).name, juce::dontSendNotification);
         delayTimeLabel.setJustificationType(juce::Justification::centred);
         delayTimeLabel.attachToComponent(&delayTimeSlider, false);
         addAndMakeVisible(delayTimeLabel);
@@ -56,7 +60,7 @@ namespace EchoSphere
         feedbackSlider.setColour(juce::Slider::textBoxBackgroundColourId, juce::Colours::darkgrey);
         addAndMakeVisible(feedbackSlider);
         
-        feedbackLabel.setText("Feedback", juce::dontSendNotification);
+        feedbackLabel.setText(getParamDescriptor(ParamIndex::FEEDBACK).name, juce::dontSendNotification);
         feedbackLabel.setJustificationType(juce::Justification::centred);
         feedbackLabel.attachToComponent(&feedbackSlider, false);
         addAndMakeVisible(feedbackLabel);
@@ -68,7 +72,7 @@ namespace EchoSphere
         mixSlider.setColour(juce::Slider::textBoxBackgroundColourId, juce::Colours::darkgrey);
         addAndMakeVisible(mixSlider);
         
-        mixLabel.setText("Mix", juce::dontSendNotification);
+        mixLabel.setText(getParamDescriptor(ParamIndex::MIX).name, juce::dontSendNotification);
         mixLabel.setJustificationType(juce::Justification::centred);
         mixLabel.attachToComponent(&mixSlider, false);
         addAndMakeVisible(mixLabel);
@@ -79,18 +83,59 @@ namespace EchoSphere
         addAndMakeVisible(syncToggle);
         
         // Sync Note Combo
-        syncNoteCombo.addItemList({ "1/1", "1/2", "1/4", "1/8", "1/16", "1/32", "1/64", 
-                                    "1/2D", "1/4D", "1/8D", "1/16D", 
-                                    "1/2T", "1/4T", "1/8T", "1/16T" }, 1);
+        syncNoteCombo.addItemList(Parameters::getChoiceNames(ParamIndex::SYNC_NOTE), 1);
         syncNoteCombo.setJustificationType(juce::Justification::centred);
-        syncNoteCombo.setSelectedId(3, juce::dontSendNotification); // Quarter note default
+        syncNoteCombo.setSelectedId(static_cast<int>(getParamDescriptor(ParamIndex::SYNC_NOTE).defaultValue) + 1,
+                                    juce::dontSendNotification); // Quarter note default
         addAndMakeVisible(syncNoteCombo);
         
         syncNoteLabel.setText("Note Value", juce::dontSendNotification);
         syncNoteLabel.setJustificationType(juce::Justification::centred);
         syncNoteLabel.attachToComponent(&syncNoteCombo, false);
         addAndMakeVisible(syncNoteLabel);
+        
+       #if ECHOSPHERE_PROFILER
+        // Profiler readout and dump button
+        profilerLabel.setFont(juce::Font(12.0f));
+        profilerLabel.setColour(juce::Label::textColourId, juce::Colours::lightgrey);
+        addAndMakeVisible(profilerLabel);
+        
+        profilerDumpButton.setButtonText("Dump Profile");
+        profilerDumpButton.onClick = [this] { dumpProfile(); };
+        addAndMakeVisible(profilerDumpButton);
+       #endif
     }
+    
+   #if ECHOSPHERE_PROFILER
+    void EchoSphereAudioProcessorEditor::timerCallback()
+    {
+        const auto snapshot = processorRef.getProfiler().getSnapshot();
+        const auto& blockStats = snapshot.stages[Profiler::block];
+        
+        if (blockStats.count == 0 || snapshot.cyclesPerSecond <= 0.0)
+            return;
+            
+        const double microsecondsPerCycle = 1.0e6 / snapshot.cyclesPerSecond;
+        const double meanMicroseconds = static_cast<double>(blockStats.totalCycles) / static_cast<double>(blockStats.count)
+                                      * microsecondsPerCycle;
+        const double maxMicroseconds = static_cast<double>(blockStats.maxCycles) * microsecondsPerCycle;
+        
+        profilerLabel.setText("Block avg " + juce::String(meanMicroseconds, 1) + " us, max "
+                              + juce::String(maxMicroseconds, 1) + " us, over budget "
+                              + juce::String(static_cast<juce::int64>(snapshot.deadlineMisses)) + " / "
+                              + juce::String(static_cast<juce::int64>(blockStats.count)),
+                              juce::dontSendNotification);
+    }
+    
+    void EchoSphereAudioProcessorEditor::dumpProfile()
+    {
+        const auto file = juce::File::getSpecialLocation(juce::File::userDocumentsDirectory)
+                              .getNonexistentChildFile("EchoSphere Profile", ".txt");
+        
+        if (processorRef.getProfiler().dumpToFile(file))
+            profilerLabel.setText("Profile written to " + file.getFullPathName(), juce::dontSendNotification);
+    }
+   #endif
 
     void EchoSphereAudioProcessorEditor::paint(juce::Graphics& g)
     {
@@ -137,5 +182,12 @@ namespace EchoSphere
         
         // Note value combo (only visible when sync is enabled)
         syncNoteCombo.setBounds(syncArea.removeFromLeft(100).withTrimmedTop(15));
+        
+       #if ECHOSPHERE_PROFILER
+        // Profiler readout along the bottom edge
+        auto profilerArea = getLocalBounds().reduced(10).removeFromBottom(20);
+        profilerDumpButton.setBounds(profilerArea.removeFromRight(100));
+        profilerLabel.setBounds(profilerArea);
+       #endif
     }
 } 
\ No newline at end of file
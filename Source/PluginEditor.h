@@ -6,6 +6,9 @@
 namespace EchoSphere
 {
     class EchoSphereAudioProcessorEditor : public juce::AudioProcessorEditor
+                                         #if ECHOSPHERE_PROFILER
+                                          , private juce::Timer
+                                         #endif
     {
     public:
         explicit EchoSphereAudioProcessorEditor(EchoSphereAudioProcessor&);
@@ -43,6 +46,15 @@ namespace EchoSphere
         // Setup UI components with initial properties
         void setupUIComponents();
         
+       #if ECHOSPHERE_PROFILER
+        // Profiler readout
+        juce::Label profilerLabel;
+        juce::TextButton profilerDumpButton;
+        
+        void timerCallback() override;
+        void dumpProfile();
+       #endif
+        
         JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(EchoSphereAudioProcessorEditor)
     };
 } 
\ No newline at end of file
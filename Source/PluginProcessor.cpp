@@ -11,34 +11,56 @@ namespace EchoSphere
         , parameters(*this, nullptr, "EchoSphereParameters", Parameters::createParameterLayout())
     {
         // Link parameter pointers to the actual parameters
-        delayTimeParameter = parameters.getRawParameterValue(ParamIDs::DELAY_TIME);
-        feedbackParameter = parameters.getRawParameterValue(ParamIDs::FEEDBACK);
-        mixParameter = parameters.getRawParameterValue(ParamIDs::MIX);
-        syncParameter = parameters.getRawParameterValue(ParamIDs::SYNC);
-        syncNoteParameter = parameters.getRawParameterValue(ParamIDs::SYNC_NOTE);
+        linkParameterPointers();
+        
+        parameters.addParameterListener(ParamIDs::WET_PATH_RATE, this);
     }
 
     EchoSphereAudioProcessor::~EchoSphereAudioProcessor()
     {
+        parameters.removeParameterListener(ParamIDs::WET_PATH_RATE, this);
+        cancelPendingUpdate();
     }
 
-    void EchoSphereAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
+    void EchoSphereAudioProcessor::linkParameterPointers()
     {
-        // Ensure parameters are valid
-        if (!delayTimeParameter || !feedbackParameter || !mixParameter || !syncParameter || !syncNoteParameter)
+        // The only string lookups: every parameter was created from the same table
+        for (const auto& descriptor : parameterDescriptors)
         {
-            // Reinitialize parameter pointers
-            delayTimeParameter = parameters.getRawParameterValue(ParamIDs::DELAY_TIME);
-            feedbackParameter = parameters.getRawParameterValue(ParamIDs::FEEDBACK);
-            mixParameter = parameters.getRawParameterValue(ParamIDs::MIX);
-            syncParameter = parameters.getRawParameterValue(ParamIDs::SYNC);
-            syncNoteParameter = parameters.getRawParameterValue(ParamIDs::SYNC_NOTE);
-            
-            // If still invalid, we can't proceed
-            if (!delayTimeParameter || !feedbackParameter || !mixParameter || !syncParameter || !syncNoteParameter)
-                return;
+            parameterObjects[descriptor.index] = parameters.getParameter(descriptor.id);
+            parameterValues[descriptor.index] = parameters.getRawParameterValue(descriptor.id);
+            jassert(parameterObjects[descriptor.index] != nullptr && parameterValues[descriptor.index] != nullptr);
         }
-    
+        
+        cacheParameterValues();
+    }
+
+    void EchoSphereAudioProcessor::cacheParameterValues() noexcept
+    {
+        for (size_t i = 0; i < parameterValues.size(); ++i)
+            parameterCache[i] = parameterValues[i]->load(std::memory_order_relaxed);
+    }
+
+    void EchoSphereAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
+    {
+        prepareDelayLines(sampleRate, samplesPerBlock);
+        
+        // Partition the reverb IR and start its tail worker (never on the audio thread)
+        reverb.prepare(sampleRate, getTotalNumOutputChannels());
+        
+       #if ECHOSPHERE_PROFILER
+        profiler.prepare(sampleRate);
+       #endif
+
+        // Initialize delay parameters
+        cacheParameterValues();
+        updateDelayParameters();
+    }
+
+    void EchoSphereAudioProcessor::prepareDelayLines(double sampleRate, int samplesPerBlock)
+    {
+        preparedWetPathDivisor = getWetPathDivisor(sampleRate);
+        
         // Resize the delay line vector if needed
         delayLines.clear();
         delayLines.resize(getTotalNumInputChannels());
@@ -46,16 +68,56 @@ namespace EchoSphere
         // Initialize all delay lines
         for (auto& delayLine : delayLines)
         {
-            delayLine.prepare(sampleRate);
+            delayLine.prepare(sampleRate, samplesPerBlock, preparedWetPathDivisor);
         }
+        
+        // Delay memory is prefaulted by prepare; optionally pin it so the audio thread
+        // can't fault on it later either. A low RLIMIT_MEMLOCK just leaves it unlocked.
+        bool allLocked = lockDelayMemory && !delayLines.empty();
+        
+        if (lockDelayMemory)
+            for (auto& delayLine : delayLines)
+                allLocked = delayLine.lockMemory() && allLocked;
+                
+        delayMemoryLocked.store(allLocked);
+    }
 
-        // Initialize delay parameters
+    int EchoSphereAudioProcessor::getWetPathDivisor(double sampleRate) const
+    {
+        switch (static_cast<int>(getParameterValue(ParamIndex::WET_PATH_RATE)))
+        {
+            case 1:  return 1; // Full
+            case 2:  return 2; // Half
+            case 3:  return 4; // Quarter
+            default: return WetPathResampler::getAutomaticDivisor(sampleRate);
+        }
+    }
+
+    void EchoSphereAudioProcessor::parameterChanged(const juce::String& parameterID, float newValue)
+    {
+        juce::ignoreUnused(parameterID, newValue);
+        triggerAsyncUpdate();
+    }
+
+    void EchoSphereAudioProcessor::handleAsyncUpdate()
+    {
+        const double sampleRate = getSampleRate();
+        
+        if (sampleRate <= 0.0 || getWetPathDivisor(sampleRate) == preparedWetPathDivisor)
+            return;
+            
+        // Rebuilding the lines allocates, so hold the audio thread off while it happens
+        suspendProcessing(true);
+        prepareDelayLines(sampleRate, getBlockSize());
+        cacheParameterValues();
         updateDelayParameters();
+        suspendProcessing(false);
     }
 
     void EchoSphereAudioProcessor::releaseResources()
     {
-        // Nothing to release in this simple implementation
+        // Stop the reverb's background tail worker
+        reverb.release();
     }
 
     bool EchoSphereAudioProcessor::isBusesLayoutSupported(const BusesLayout& layouts) const
@@ -75,6 +137,7 @@ namespace EchoSphere
     void EchoSphereAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
     {
         juce::ScopedNoDenormals noDenormals;
+        ECHOSPHERE_PROFILE_BLOCK(profiler, buffer.getNumSamples());
         
         // Safety check - if no channels or no samples, nothing to do
         if (buffer.getNumChannels() == 0 || buffer.getNumSamples() == 0)
@@ -87,62 +150,66 @@ namespace EchoSphere
         for (auto i = getTotalNumInputChannels(); i < getTotalNumOutputChannels(); ++i)
             buffer.clear(i, 0, numSamples);
 
-        // Make sure delayLines is properly initialized
-        if (delayLines.empty() || delayLines.size() < getTotalNumInputChannels())
-        {
-            // If not initialized, re-initialize
-            prepareToPlay(getSampleRate(), buffer.getNumSamples());
-            
-            // If still not initialized properly, just pass through audio
-            if (delayLines.empty())
-                return;
-        }
+        // Not prepared for this layout yet: pass the audio through. Preparing allocates,
+        // partitions the reverb IR and starts its worker, none of which belongs here.
+        if (delayLines.empty() || delayLines.size() < static_cast<size_t>(getTotalNumInputChannels()))
+            return;
         
-        // Check if parameters are valid
-        if (!delayTimeParameter || !feedbackParameter || !mixParameter || !syncParameter || !syncNoteParameter)
+        // Update parameters if needed
         {
-            // Reinitialize parameter pointers
-            delayTimeParameter = parameters.getRawParameterValue(ParamIDs::DELAY_TIME);
-            feedbackParameter = parameters.getRawParameterValue(ParamIDs::FEEDBACK);
-            mixParameter = parameters.getRawParameterValue(ParamIDs::MIX);
-            syncParameter = parameters.getRawParameterValue(ParamIDs::SYNC);
-            syncNoteParameter = parameters.getRawParameterValue(ParamIDs::SYNC_NOTE);
-            
-            // If still invalid, just pass through audio
-            if (!delayTimeParameter || !feedbackParameter || !mixParameter || !syncParameter || !syncNoteParameter)
-                return;
+            ECHOSPHERE_PROFILE_STAGE(profiler, parameterUpdate);
+            cacheParameterValues();
+            updateDelayParameters();
         }
 
-        // Update parameters if needed
-        updateDelayParameters();
-
-        // Process each channel through its own delay line
-        for (int channel = 0; channel < juce::jmin(numChannels, static_cast<int>(delayLines.size())); ++channel)
         {
-            if (channel < buffer.getNumChannels()) // Extra safety check
+            ECHOSPHERE_PROFILE_STAGE(profiler, delayKernel);
+            
+            if (isMidSideActive(numChannels))
+            {
+                // Mid/side: line 0 carries mid, line 1 carries side, fused in one stereo pass
+                delayLines[0].processMidSideBlock(delayLines[1], buffer);
+            }
+            else
             {
-                delayLines[channel].processBlock(buffer, channel);
+                // Process each channel through its own delay line
+                for (int channel = 0; channel < juce::jmin(numChannels, static_cast<int>(delayLines.size())); ++channel)
+                {
+                    if (channel < buffer.getNumChannels()) // Extra safety check
+                    {
+                        delayLines[channel].processBlock(buffer, channel);
+                    }
+                }
             }
         }
+        
+        // Reverb runs on the delayed signal
+        {
+            ECHOSPHERE_PROFILE_STAGE(profiler, reverb);
+            reverb.setMix(cachedValue<ParamIndex::REVERB_MIX>());
+            reverb.setNonRealtime(isNonRealtime());
+            reverb.processBlock(buffer);
+        }
     }
 
     void EchoSphereAudioProcessor::updateDelayParameters()
     {
-        // Check if parameters are valid before dereferencing
-        if (!delayTimeParameter || !feedbackParameter || !mixParameter || !syncParameter || !syncNoteParameter)
-            return;
-            
         // Get current parameter values
-        float delayTime = *delayTimeParameter;
-        float feedback = *feedbackParameter;
-        float mix = *mixParameter;
-        bool sync = *syncParameter > 0.5f;
-        int syncNoteIndex = static_cast<int>(*syncNoteParameter);
+        float delayTime = cachedValue<ParamIndex::DELAY_TIME>();
+        float feedback = cachedValue<ParamIndex::FEEDBACK>();
+        float mix = cachedValue<ParamIndex::MIX>();
+        bool sync = cachedValue<ParamIndex::SYNC>() > 0.5f;
+        int syncNoteIndex = static_cast<int>(cachedValue<ParamIndex::SYNC_NOTE>());
+        
+        // Samples until a synced delay time change takes effect (0 = now)
+        int syncChangeOffset = 0;
 
         // If sync is enabled, calculate delay time based on host tempo
         if (sync)
         {
             double bpm = 120.0; // Default to 120 BPM if host doesn't provide tempo
+            double ppqPosition = 0.0;
+            bool isPlaying = false;
             
             auto playHead = getPlayHead();
             if (playHead != nullptr)
@@ -153,6 +220,12 @@ namespace EchoSphere
                 {
                     if (position->getBpm().hasValue())
                         bpm = *position->getBpm();
+                        
+                    if (position->getPpqPosition().hasValue())
+                    {
+                        ppqPosition = *position->getPpqPosition();
+                        isPlaying = position->getIsPlaying();
+                    }
                 }
                 #else
                 // For older JUCE versions
@@ -160,25 +233,67 @@ namespace EchoSphere
                 if (playHead->getCurrentPosition(positionInfo))
                 {
                     bpm = positionInfo.bpm;
+                    ppqPosition = positionInfo.ppqPosition;
+                    isPlaying = positionInfo.isPlaying;
                 }
                 #endif
             }
 
             delayTime = calculateSyncedDelayTime(static_cast<float>(bpm), syncNoteIndex);
+            
+            // While the transport runs, a tempo or note change lands on the next boundary
+            // of the synced note's grid rather than part way through a repeat
+            if (isPlaying && bpm > 0.0)
+            {
+                const double noteInQuarters = delayTime * bpm / 60000.0;
+                const double intoNote = std::fmod(ppqPosition, noteInQuarters);
+                const double quartersToBoundary = intoNote < 1.0e-6 ? 0.0 : noteInQuarters - intoNote;
+                
+                syncChangeOffset = static_cast<int>(std::round(quartersToBoundary * 60.0 / bpm * getSampleRate()));
+            }
         }
 
         // Update all delay lines with current parameters
         if (delayLines.empty())
             return;
             
-        for (auto& delayLine : delayLines)
+        // In mid/side mode the second line carries side with its own time and feedback.
+        // Each line gets exactly one delay time per block, since every change starts a
+        // crossfade.
+        const bool midSide = isMidSideActive(static_cast<int>(delayLines.size()));
+        
+        for (size_t i = 0; i < delayLines.size(); ++i)
         {
-            delayLine.setDelayTime(delayTime);
-            delayLine.setFeedback(feedback);
+            auto& delayLine = delayLines[i];
+            
+            if (midSide && i == 1)
+            {
+                delayLine.setDelayTime(cachedValue<ParamIndex::SIDE_DELAY_TIME>());
+                delayLine.setFeedback(cachedValue<ParamIndex::SIDE_FEEDBACK>());
+            }
+            else
+            {
+                delayLine.scheduleDelayTime(delayTime, syncChangeOffset);
+                delayLine.setFeedback(feedback);
+            }
+            
             delayLine.setMix(mix);
+            delayLine.setPitchShift(cachedValue<ParamIndex::PITCH_SHIFT>());
+            delayLine.setShimmer(cachedValue<ParamIndex::SHIMMER>());
+            delayLine.setFreeze(cachedValue<ParamIndex::FREEZE>() > 0.5f);
+            delayLine.setReverse(cachedValue<ParamIndex::REVERSE>() > 0.5f);
         }
     }
 
+    bool EchoSphereAudioProcessor::isMidSideActive(int numChannels) const
+    {
+        const int modeIndex = juce::jlimit(0, static_cast<int>(std::size(stereoModeChoices)) - 1,
+                                           static_cast<int>(cachedValue<ParamIndex::STEREO_MODE>()));
+        
+        return stereoModeChoices[modeIndex] == StereoMode::MID_SIDE
+            && numChannels >= 2 && delayLines.size() >= 2;
+    }
+
     float EchoSphereAudioProcessor::calculateSyncedDelayTime(float bpm, int syncNoteIndex)
     {
         // Calculate note durations based on BPM
@@ -243,16 +358,31 @@ namespace EchoSphere
         return quarterNoteMs * multiplier;
     }
 
-    float EchoSphereAudioProcessor::getParameterValue(const juce::String& parameterID)
+    bool EchoSphereAudioProcessor::loadReverbImpulseResponse(const juce::File& file)
+    {
+        if (!reverb.loadImpulseResponse(file))
+            return false;
+            
+        // Remember the file so the IR is restored with the rest of the state
+        parameters.state.setProperty(reverbImpulseProperty, file.getFullPathName(), nullptr);
+        return true;
+    }
+
+    float EchoSphereAudioProcessor::getParameterValue(ParamIndex::Index index) const
     {
-        if (auto* param = parameters.getRawParameterValue(parameterID))
-            return *param;
-        return 0.0f;
+        if (index < 0 || index >= ParamIndex::NUM_PARAMETERS || parameterValues[index] == nullptr)
+            return 0.0f;
+        return *parameterValues[index];
     }
 
     juce::AudioProcessorEditor* EchoSphereAudioProcessor::createEditor()
     {
+       #if ECHOSPHERE_PROFILER
+        // Profiling builds need the custom editor for the readout and the dump button
+        return new EchoSphereAudioProcessorEditor(*this);
+       #else
         return new juce::GenericAudioProcessorEditor(*this);
+       #endif
     }
 
     bool EchoSphereAudioProcessor::hasEditor() const
@@ -283,8 +413,9 @@ namespace EchoSphere
     double EchoSphereAudioProcessor::getTailLengthSeconds() const
     {
         // Return a reasonable tail length based on max delay time and feedback
-        // For safety, we'll use a fairly large value to accommodate high feedback settings
-        return 5.0;
+        // For safety, we'll use a fairly large value to accommodate high feedback settings,
+        // plus the length of the reverb's impulse response
+        return 5.0 + reverb.getImpulseLengthSeconds();
     }
 
     int EchoSphereAudioProcessor::getNumPrograms()
@@ -315,19 +446,69 @@ namespace EchoSphere
 
     void EchoSphereAudioProcessor::getStateInformation(juce::MemoryBlock& destData)
     {
-        // Save parameter state as XML
-        auto state = parameters.copyState();
-        std::unique_ptr<juce::XmlElement> xml(state.createXml());
-        copyXmlToBinary(*xml, destData);
+        // Save parameter values in descriptor order, followed by the reverb IR path
+        juce::MemoryOutputStream stream(destData, false);
+        stream.writeInt(binaryStateMagic);
+        stream.writeInt(binaryStateVersion);
+        stream.writeInt(ParamIndex::NUM_PARAMETERS);
+        
+        for (auto* value : parameterValues)
+            stream.writeFloat(value->load());
+            
+        stream.writeString(parameters.state.getProperty(reverbImpulseProperty).toString());
     }
 
     void EchoSphereAudioProcessor::setStateInformation(const void* data, int sizeInBytes)
     {
-        // Restore parameter state from XML
+        if (setBinaryState(data, sizeInBytes))
+            return;
+            
+        // Older sessions stored the parameter tree as XML
         std::unique_ptr<juce::XmlElement> xmlState(getXmlFromBinary(data, sizeInBytes));
         
         if (xmlState != nullptr && xmlState->hasTagName(parameters.state.getType()))
+        {
             parameters.replaceState(juce::ValueTree::fromXml(*xmlState));
+            reloadReverbImpulseResponse();
+        }
+    }
+
+    bool EchoSphereAudioProcessor::setBinaryState(const void* data, int sizeInBytes)
+    {
+        if (data == nullptr || sizeInBytes < 3 * static_cast<int>(sizeof(int)))
+            return false;
+            
+        juce::MemoryInputStream stream(data, static_cast<size_t>(sizeInBytes), false);
+        
+        if (stream.readInt() != binaryStateMagic || stream.readInt() > binaryStateVersion)
+            return false;
+            
+        // A state from a build with fewer parameters leaves the newer ones untouched;
+        // values from a build with more are skipped
+        const int numStored = stream.readInt();
+        
+        for (int i = 0; i < numStored && !stream.isExhausted(); ++i)
+        {
+            const float value = stream.readFloat();
+            
+            if (i < ParamIndex::NUM_PARAMETERS)
+            {
+                auto* parameter = parameterObjects[static_cast<size_t>(i)];
+                parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+            }
+        }
+        
+        parameters.state.setProperty(reverbImpulseProperty, stream.readString(), nullptr);
+        reloadReverbImpulseResponse();
+        return true;
+    }
+
+    void EchoSphereAudioProcessor::reloadReverbImpulseResponse()
+    {
+        // Reload a user impulse response if one was saved
+        const juce::File impulseFile(parameters.state.getProperty(reverbImpulseProperty).toString());
+        if (impulseFile.existsAsFile())
+            reverb.loadImpulseResponse(impulseFile);
     }
 }
 
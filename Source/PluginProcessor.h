@@ -3,10 +3,14 @@
 #include "JuceHeader.h"
 #include "Parameters.h"
 #include "DelayLine.h"
+#include "ConvolutionReverb.h"
+#include "Profiler.h"
 
 namespace EchoSphere
 {
     class EchoSphereAudioProcessor : public juce::AudioProcessor
+                                   , private juce::AudioProcessorValueTreeState::Listener
+                                   , private juce::AsyncUpdater
     {
     public:
         EchoSphereAudioProcessor();
@@ -43,11 +47,27 @@ namespace EchoSphere
         juce::AudioProcessorValueTreeState& getParameterTree() { return parameters; }
         
         // Utility function to get a parameter's raw value
-        float getParameterValue(const juce::String& parameterID);
+        float getParameterValue(ParamIndex::Index index) const;
         
         // Convert sync note index to delay time in ms based on host tempo
         float calculateSyncedDelayTime(float bpm, int syncNoteIndex);
         
+        // Whether prepareToPlay should mlock the delay memory (on by default). Memory is
+        // always prefaulted; locking additionally keeps it from being paged out.
+        void setLockDelayMemory(bool shouldLock) { lockDelayMemory = shouldLock; }
+        
+        // True if every delay buffer was locked by the last prepareToPlay
+        bool isDelayMemoryLocked() const { return delayMemoryLocked.load(); }
+        
+        // Load an impulse response file into the reverb (message thread only). The path is
+        // saved with the state.
+        bool loadReverbImpulseResponse(const juce::File& file);
+        
+       #if ECHOSPHERE_PROFILER
+        // Per-block and per-stage timing statistics (readable from any thread)
+        Profiler& getProfiler() { return profiler; }
+       #endif
+        
     private:
         // Parameter handling
         juce::AudioProcessorValueTreeState parameters;
@@ -55,16 +75,70 @@ namespace EchoSphere
         // Delay lines (one per channel for stereo)
         std::vector<DelayLine> delayLines;
         
-        // Parameter change listeners
-        std::atomic<float>* delayTimeParameter = nullptr;
-        std::atomic<float>* feedbackParameter = nullptr;
-        std::atomic<float>* mixParameter = nullptr;
-        std::atomic<float>* syncParameter = nullptr;
-        std::atomic<float>* syncNoteParameter = nullptr;
+        bool lockDelayMemory = true;
+        std::atomic<bool> delayMemoryLocked { false };
+        
+        // Rate divisor the delay lines were last prepared with
+        int preparedWetPathDivisor = 1;
+        
+        // Convolution reverb after the delay stage
+        ConvolutionReverb reverb;
+        
+       #if ECHOSPHERE_PROFILER
+        Profiler profiler;
+       #endif
+        
+        // Parameter objects and their raw values, linked once by index from the descriptor table
+        std::array<juce::RangedAudioParameter*, ParamIndex::NUM_PARAMETERS> parameterObjects {};
+        std::array<std::atomic<float>*, ParamIndex::NUM_PARAMETERS> parameterValues {};
+        
+        // Copy of every value taken at the start of each block, so the audio thread reads
+        // parameters from one contiguous array by compile-time index
+        std::array<float, ParamIndex::NUM_PARAMETERS> parameterCache {};
+        
+        // State property holding the path of a user-loaded reverb IR
+        inline static const juce::Identifier reverbImpulseProperty { "reverb_ir" };
+        
+        // Binary state: magic, version, parameter count, values in ParamIndex order, IR path
+        static constexpr int binaryStateMagic = 0x45535031; // "ESP1"
+        static constexpr int binaryStateVersion = 1;
+        
+        // Link the parameter pointers from the descriptor table (constructor only)
+        void linkParameterPointers();
+        
+        // Snapshot all parameter values into parameterCache (audio thread)
+        void cacheParameterValues() noexcept;
+        
+        template <ParamIndex::Index index>
+        float cachedValue() const noexcept
+        {
+            static_assert(index >= 0 && index < ParamIndex::NUM_PARAMETERS, "Invalid parameter index");
+            return parameterCache[index];
+        }
+        
+        // Restore from the binary layout; returns false if the data isn't in that format
+        bool setBinaryState(const void* data, int sizeInBytes);
+        
+        // Reload the user impulse response named in the state, if any
+        void reloadReverbImpulseResponse();
         
         // Update delay parameters based on the current parameter values
         void updateDelayParameters();
         
+        // (Re)build the delay lines for the current wet path rate and lock their memory
+        void prepareDelayLines(double sampleRate, int samplesPerBlock);
+        
+        // Wet path rate divisor (1, 2 or 4) selected by the Wet Path Rate parameter
+        int getWetPathDivisor(double sampleRate) const;
+        
+        // A wet path rate change reallocates the delay lines, so it's deferred to the
+        // message thread
+        void parameterChanged(const juce::String& parameterID, float newValue) override;
+        void handleAsyncUpdate() override;
+        
+        // True when the stereo mode is mid/side and there is a stereo pair to run it on
+        bool isMidSideActive(int numChannels) const;
+        
         JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(EchoSphereAudioProcessor)
     };
 } 
\ No newline at end of file
@@ -0,0 +1,183 @@
+#include "Profiler.h"
+
+#if ECHOSPHERE_PROFILER
+
+namespace EchoSphere
+{
+    Profiler::Profiler()
+    {
+        reset();
+    }
+
+    void Profiler::prepare(double sampleRate)
+    {
+        currentSampleRate.store(sampleRate);
+
+        // Calibrate the cycle counter against the high resolution clock (once is enough)
+        if (cyclesPerSecond.load() <= 0.0)
+            calibrate();
+
+        reset();
+    }
+
+    void Profiler::calibrate()
+    {
+        const auto startTicks = juce::Time::getHighResolutionTicks();
+        const auto startCycles = readCycleCounter();
+        juce::Thread::sleep(20);
+        const auto elapsedCycles = readCycleCounter() - startCycles;
+        const auto elapsedSeconds = static_cast<double>(juce::Time::getHighResolutionTicks() - startTicks)
+                                  / static_cast<double>(juce::Time::getHighResolutionTicksPerSecond());
+
+        if (elapsedSeconds > 0.0)
+            cyclesPerSecond.store(static_cast<double>(elapsedCycles) / elapsedSeconds);
+    }
+
+    void Profiler::reset()
+    {
+        for (auto& stage : stages)
+        {
+            stage.count.store(0, std::memory_order_relaxed);
+            stage.totalCycles.store(0, std::memory_order_relaxed);
+            stage.maxCycles.store(0, std::memory_order_relaxed);
+
+            for (auto& bin : stage.histogram)
+                bin.store(0, std::memory_order_relaxed);
+        }
+
+        deadlineMisses.store(0, std::memory_order_relaxed);
+    }
+
+    int Profiler::getBinForCycles(juce::uint64 cycles) noexcept
+    {
+        if (cycles < 4)
+            return static_cast<int>(cycles);
+
+       #if JUCE_MSVC
+        unsigned long highestBit;
+        _BitScanReverse64(&highestBit, cycles);
+        const int msb = static_cast<int>(highestBit);
+       #else
+        const int msb = 63 - __builtin_clzll(cycles);
+       #endif
+
+        // Octave plus the next two bits below the top one
+        return juce::jmin(numBins - 1, (msb - 1) * 4 + static_cast<int>((cycles >> (msb - 2)) & 3));
+    }
+
+    juce::uint64 Profiler::getBinLowerBound(int bin) noexcept
+    {
+        if (bin < 4)
+            return static_cast<juce::uint64>(bin);
+
+        const int msb = bin / 4 + 1;
+        return static_cast<juce::uint64>(4 + bin % 4) << (msb - 2);
+    }
+
+    void Profiler::record(Stage stage, juce::uint64 cycles) noexcept
+    {
+        // Single writer: plain load/store keeps the audio thread free of locked RMW instructions
+        auto& stats = stages[stage];
+        stats.count.store(stats.count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        stats.totalCycles.store(stats.totalCycles.load(std::memory_order_relaxed) + cycles, std::memory_order_relaxed);
+
+        if (cycles > stats.maxCycles.load(std::memory_order_relaxed))
+            stats.maxCycles.store(cycles, std::memory_order_relaxed);
+
+        auto& bin = stats.histogram[getBinForCycles(cycles)];
+        bin.store(bin.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    void Profiler::recordBlock(juce::uint64 cycles, int numSamples) noexcept
+    {
+        record(block, cycles);
+
+        const double sampleRate = currentSampleRate.load(std::memory_order_relaxed);
+
+        if (sampleRate <= 0.0 || numSamples <= 0)
+            return;
+
+        // The block's time budget is the duration of the audio it produced
+        const double budgetCycles = numSamples / sampleRate * cyclesPerSecond.load(std::memory_order_relaxed);
+
+        if (static_cast<double>(cycles) > budgetCycles * deadlineShare.load(std::memory_order_relaxed))
+            deadlineMisses.store(deadlineMisses.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    Profiler::Snapshot Profiler::getSnapshot() const
+    {
+        Snapshot snapshot;
+        snapshot.cyclesPerSecond = cyclesPerSecond.load();
+        snapshot.sampleRate = currentSampleRate.load();
+        snapshot.deadlineShare = deadlineShare.load();
+        snapshot.deadlineMisses = deadlineMisses.load(std::memory_order_relaxed);
+
+        for (int i = 0; i < numStages; ++i)
+        {
+            auto& source = stages[i];
+            auto& dest = snapshot.stages[static_cast<size_t>(i)];
+            dest.count = source.count.load(std::memory_order_relaxed);
+            dest.totalCycles = source.totalCycles.load(std::memory_order_relaxed);
+            dest.maxCycles = source.maxCycles.load(std::memory_order_relaxed);
+
+            for (int bin = 0; bin < numBins; ++bin)
+                dest.histogram[static_cast<size_t>(bin)] = source.histogram[bin].load(std::memory_order_relaxed);
+        }
+
+        return snapshot;
+    }
+
+    juce::String Profiler::getStageName(Stage stage)
+    {
+        switch (stage)
+        {
+            case block:           return "block";
+            case parameterUpdate: return "parameter_update";
+            case delayKernel:     return "delay_kernel";
+            case filter:          return "filter";
+            case modulation:      return "modulation";
+            case saturation:      return "saturation";
+            case reverb:          return "reverb";
+            case numStages:
+            default:              break;
+        }
+
+        return "unknown";
+    }
+
+    bool Profiler::dumpToFile(const juce::File& file) const
+    {
+        const auto snapshot = getSnapshot();
+        const double microsecondsPerCycle = snapshot.cyclesPerSecond > 0.0 ? 1.0e6 / snapshot.cyclesPerSecond : 0.0;
+
+        juce::String report;
+        report << "EchoSphere profile\n"
+               << "sample_rate " << snapshot.sampleRate << "\n"
+               << "cycles_per_second " << snapshot.cyclesPerSecond << "\n"
+               << "deadline_share " << snapshot.deadlineShare << "\n"
+               << "blocks " << static_cast<juce::int64>(snapshot.stages[block].count) << "\n"
+               << "deadline_misses " << static_cast<juce::int64>(snapshot.deadlineMisses) << "\n";
+
+        for (int i = 0; i < numStages; ++i)
+        {
+            const auto& stats = snapshot.stages[static_cast<size_t>(i)];
+            const double meanCycles = stats.count > 0 ? static_cast<double>(stats.totalCycles) / static_cast<double>(stats.count) : 0.0;
+
+            report << "\nstage " << getStageName(static_cast<Stage>(i)) << "\n"
+                   << "count " << static_cast<juce::int64>(stats.count) << "\n"
+                   << "mean_cycles " << meanCycles << " (" << meanCycles * microsecondsPerCycle << " us)\n"
+                   << "max_cycles " << static_cast<juce::int64>(stats.maxCycles)
+                   << " (" << static_cast<double>(stats.maxCycles) * microsecondsPerCycle << " us)\n";
+
+            // Histogram: one line per occupied bin, "lower_bound_cycles count"
+            for (int bin = 0; bin < numBins; ++bin)
+                if (stats.histogram[static_cast<size_t>(bin)] > 0)
+                    report << "bin " << static_cast<juce::int64>(getBinLowerBound(bin))
+                           << " " << static_cast<int>(stats.histogram[static_cast<size_t>(bin)]) << "\n";
+        }
+
+        return file.replaceWithText(report);
+    }
+}
+
+#endif
@@ -0,0 +1,166 @@
+#pragma once
+
+#include "JuceHeader.h"
+
+// Build with -DECHOSPHERE_PROFILER=1 (CMake option ECHOSPHERE_PROFILER) to enable.
+// When disabled the profiling macros expand to nothing and no profiler is stored.
+#ifndef ECHOSPHERE_PROFILER
+ #define ECHOSPHERE_PROFILER 0
+#endif
+
+#if ECHOSPHERE_PROFILER
+
+#if JUCE_INTEL
+ #if JUCE_MSVC
+  #include <intrin.h>
+ #else
+  #include <x86intrin.h>
+ #endif
+#endif
+
+namespace EchoSphere
+{
+    // Hot-path profiler for processBlock.
+    //
+    // The audio thread is the only writer. Every counter is a relaxed atomic, so the
+    // editor (or a dump) can read at any time without locking; a reading may mix
+    // values from adjacent blocks, which is fine for statistics.
+    class Profiler
+    {
+    public:
+        // Measured regions of processBlock. Filter, modulation and saturation are
+        // reserved for the in-loop stages so the dump layout stays stable.
+        enum Stage
+        {
+            block = 0,
+            parameterUpdate,
+            delayKernel,
+            filter,
+            modulation,
+            saturation,
+            reverb,
+            numStages
+        };
+
+        // Log-scale histogram: 4 bins per octave of cycles
+        static constexpr int numBins = 256;
+
+        struct StageStats
+        {
+            juce::uint64 count = 0;
+            juce::uint64 totalCycles = 0;
+            juce::uint64 maxCycles = 0;
+            std::array<juce::uint32, numBins> histogram {};
+        };
+
+        struct Snapshot
+        {
+            double cyclesPerSecond = 0.0;
+            double sampleRate = 0.0;
+            float deadlineShare = 0.0f;
+            juce::uint64 deadlineMisses = 0;
+            std::array<StageStats, numStages> stages;
+        };
+
+        Profiler();
+
+        // Calibrate the cycle counter and clear all statistics (not on the audio thread)
+        void prepare(double sampleRate);
+
+        // Blocks using more than this share of their buffer duration count as misses
+        void setDeadlineShare(float shareOfBuffer) { deadlineShare.store(juce::jlimit(0.01f, 10.0f, shareOfBuffer)); }
+
+        // Clear all statistics
+        void reset();
+
+        // Record one measurement (audio thread only)
+        void record(Stage stage, juce::uint64 cycles) noexcept;
+
+        // Record a whole block and check it against the deadline (audio thread only)
+        void recordBlock(juce::uint64 cycles, int numSamples) noexcept;
+
+        // Read a consistent-enough copy of all statistics from any thread
+        Snapshot getSnapshot() const;
+
+        // Write a human-readable report; returns false if the file can't be written
+        bool dumpToFile(const juce::File& file) const;
+
+        static juce::String getStageName(Stage stage);
+        static juce::uint64 getBinLowerBound(int bin) noexcept;
+
+        static juce::uint64 readCycleCounter() noexcept
+        {
+           #if JUCE_INTEL
+            return static_cast<juce::uint64>(__rdtsc());
+           #elif JUCE_ARM && (JUCE_GCC || JUCE_CLANG) && defined(__aarch64__)
+            juce::uint64 value;
+            asm volatile("mrs %0, cntvct_el0" : "=r"(value));
+            return value;
+           #else
+            return static_cast<juce::uint64>(juce::Time::getHighResolutionTicks());
+           #endif
+        }
+
+        // Times a region of code for one stage
+        class ScopedStage
+        {
+        public:
+            ScopedStage(Profiler& p, Stage s) noexcept : profiler(p), stage(s), start(readCycleCounter()) {}
+            ~ScopedStage() { profiler.record(stage, readCycleCounter() - start); }
+
+        private:
+            Profiler& profiler;
+            const Stage stage;
+            const juce::uint64 start;
+
+            JUCE_DECLARE_NON_COPYABLE(ScopedStage)
+        };
+
+        // Times a whole processBlock call, including early returns
+        class ScopedBlock
+        {
+        public:
+            ScopedBlock(Profiler& p, int samples) noexcept : profiler(p), numSamples(samples), start(readCycleCounter()) {}
+            ~ScopedBlock() { profiler.recordBlock(readCycleCounter() - start, numSamples); }
+
+        private:
+            Profiler& profiler;
+            const int numSamples;
+            const juce::uint64 start;
+
+            JUCE_DECLARE_NON_COPYABLE(ScopedBlock)
+        };
+
+    private:
+        void calibrate();
+        static int getBinForCycles(juce::uint64 cycles) noexcept;
+
+        struct AtomicStageStats
+        {
+            std::atomic<juce::uint64> count { 0 };
+            std::atomic<juce::uint64> totalCycles { 0 };
+            std::atomic<juce::uint64> maxCycles { 0 };
+            std::atomic<juce::uint32> histogram[numBins];
+        };
+
+        AtomicStageStats stages[numStages];
+        std::atomic<juce::uint64> deadlineMisses { 0 };
+        std::atomic<double> cyclesPerSecond { 0.0 };
+        std::atomic<double> currentSampleRate { 0.0 };
+        std::atomic<float> deadlineShare { 0.5f };
+
+        JUCE_DECLARE_NON_COPYABLE(Profiler)
+    };
+}
+
+ #define ECHOSPHERE_PROFILE_BLOCK(profiler, numSamples) \
+    const EchoSphere::Profiler::ScopedBlock echosphereProfileBlock(profiler, numSamples)
+ #define ECHOSPHERE_PROFILE_STAGE(profiler, stage) \
+    const EchoSphere::Profiler::ScopedStage JUCE_JOIN_MACRO(echosphereProfileStage, __LINE__)(profiler, EchoSphere::Profiler::stage)
+
+#else
+
+ #define ECHOSPHERE_PROFILE_BLOCK(profiler, numSamples)
+ #define ECHOSPHERE_PROFILE_STAGE(profiler, stage)
+
+#endif
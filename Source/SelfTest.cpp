@@ -0,0 +1,626 @@
+// EchoSphere offline self-test
+//
+// Each check drives one part of the DSP the way the processor does and compares the
+// result with a reference that is too slow for the audio thread but obviously right.
+
+#include "SelfTest.h"
+#include "ConvolutionReverb.h"
+#include "DSPKernels.h"
+#include "DelayLine.h"
+#include "MirroredRingBuffer.h"
+#include "PluginProcessor.h"
+
+namespace EchoSphere
+{
+    namespace SelfTest
+    {
+        namespace
+        {
+            struct Result
+            {
+                bool passed;
+                juce::String detail;
+            };
+
+            void fillWithNoise(juce::AudioBuffer<float>& buffer, juce::Random& random)
+            {
+                for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+                    for (int i = 0; i < buffer.getNumSamples(); ++i)
+                        buffer.setSample(channel, i, random.nextFloat() * 2.0f - 1.0f);
+            }
+
+            // Every partition tier (direct head, FFT head, background tail) against a direct
+            // convolution in double precision
+            Result checkConvolution()
+            {
+                const double sampleRate = 48000.0;
+                const int impulseLength = 2 * ConvolutionReverb::tailPartitionSize + ConvolutionReverb::tailPartitionSize / 2 + 37;
+                const int numSamples = 5 * ConvolutionReverb::tailPartitionSize;
+                juce::Random random(0x436f6e76);
+
+                juce::AudioBuffer<float> impulse(2, impulseLength);
+                juce::AudioBuffer<float> input(2, numSamples);
+                fillWithNoise(impulse, random);
+                fillWithNoise(input, random);
+
+                ConvolutionReverb reverb;
+                reverb.loadImpulseResponse(juce::AudioBuffer<float>(impulse), sampleRate);
+                reverb.prepare(sampleRate, 2);
+                reverb.setMix(100.0f);
+
+                // Wait for the tail worker rather than drop its blocks
+                reverb.setNonRealtime(true);
+
+                // Odd block sizes, so blocks straddle both kinds of partition boundary
+                juce::AudioBuffer<float> output(input);
+                const int blockSizes[] = { 1, 127, 300, 64, 1031, 2048, 5 };
+
+                for (int start = 0, block = 0; start < numSamples; ++block)
+                {
+                    const int count = juce::jmin(blockSizes[block % 7], numSamples - start);
+                    juce::AudioBuffer<float> view(output.getArrayOfWritePointers(), 2, start, count);
+                    reverb.processBlock(view);
+                    start += count;
+                }
+
+                reverb.release();
+
+                double worstError = 0.0;
+                double peak = 0.0;
+
+                for (int channel = 0; channel < 2; ++channel)
+                {
+                    const auto* h = impulse.getReadPointer(channel);
+                    const auto* x = input.getReadPointer(channel);
+
+                    for (int i = 0; i < numSamples; ++i)
+                    {
+                        double expected = 0.0;
+
+                        for (int k = 0; k <= juce::jmin(i, impulseLength - 1); ++k)
+                            expected += static_cast<double>(h[k]) * x[i - k];
+
+                        worstError = juce::jmax(worstError, std::abs(output.getSample(channel, i) - expected));
+                        peak = juce::jmax(peak, std::abs(expected));
+                    }
+                }
+
+                const double relativeError = worstError / juce::jmax(peak, 1.0e-9);
+                return { relativeError < 1.0e-4, "worst error " + juce::String(relativeError, 8) + " of peak" };
+            }
+
+            // Largest difference from the baseline kernels, relative to each sample's scale
+            constexpr float kernelTolerance = 1.0e-5f;
+
+            // Every entry of one kernel table, run on the same pseudo-random inputs. Each output
+            // sample is stored with the magnitude its rounding error scales with.
+            struct KernelOutput
+            {
+                std::vector<float> values;
+                std::vector<float> scales;
+            };
+
+            KernelOutput runKernelTable(const Kernels::Table& table)
+            {
+                juce::Random random(0x4b65726e);
+                KernelOutput output;
+
+                auto noise = [&random](int numSamples)
+                {
+                    std::vector<float> samples(static_cast<size_t>(numSamples));
+
+                    for (auto& sample : samples)
+                        sample = random.nextFloat() * 2.0f - 1.0f;
+
+                    return samples;
+                };
+
+                auto record = [&output](const std::vector<float>& samples)
+                {
+                    for (const float sample : samples)
+                    {
+                        output.values.push_back(sample);
+                        output.scales.push_back(1.0f + std::abs(sample));
+                    }
+                };
+
+                auto fade = [](int numSamples)
+                {
+                    std::vector<float> ramp(static_cast<size_t>(numSamples));
+
+                    for (int i = 0; i < numSamples; ++i)
+                        ramp[static_cast<size_t>(i)] = static_cast<float>(i) / static_cast<float>(numSamples);
+
+                    return ramp;
+                };
+
+                // Lengths that leave a remainder after every vector width, then the fixed sizes
+                for (const int n : { 1, 7, 37, 999 })
+                {
+                    {
+                        auto acc = noise(2 * n);
+                        const auto a = noise(2 * n);
+                        const auto b = noise(2 * n);
+                        table.complexMultiplyAccumulate(acc.data(), a.data(), b.data(), n);
+                        record(acc);
+                    }
+
+                    {
+                        const auto a = noise(n);
+                        const auto b = noise(n);
+                        float magnitude = 1.0f;
+
+                        for (int i = 0; i < n; ++i)
+                            magnitude += std::abs(a[static_cast<size_t>(i)] * b[static_cast<size_t>(i)]);
+
+                        // Summation order differs between variants, so allow for the whole sum
+                        output.values.push_back(table.dotProduct(a.data(), b.data(), n));
+                        output.scales.push_back(magnitude);
+                    }
+
+                    {
+                        auto io = noise(n);
+                        const auto wet = noise(n);
+                        table.mixDryWet(io.data(), wet.data(), 0.3f, 0.7f, n);
+                        record(io);
+                    }
+
+                    {
+                        auto io = noise(n);
+                        auto write = noise(n);
+                        const auto older = noise(n + 1);
+                        table.delayBlock(io.data(), write.data(), older.data(), random.nextFloat(), 0.6f, 0.4f, 0.8f, n);
+                        record(io);
+                        record(write);
+                    }
+
+                    {
+                        auto left = noise(n);
+                        auto right = noise(n);
+                        auto midWrite = noise(n);
+                        auto sideWrite = noise(n);
+                        const auto midOlder = noise(n + 1);
+                        const auto sideOlder = noise(n + 1);
+                        table.midSideDelayBlock(left.data(), right.data(), midWrite.data(), sideWrite.data(),
+                                                midOlder.data(), sideOlder.data(), random.nextFloat(), random.nextFloat(),
+                                                0.5f, 0.7f, 0.4f, 0.8f, n);
+                        record(left);
+                        record(right);
+                        record(midWrite);
+                        record(sideWrite);
+                    }
+
+                    {
+                        auto interpolated = noise(n);
+                        const auto older = noise(n + 1);
+                        table.interpolateBlock(interpolated.data(), older.data(), random.nextFloat(), n);
+                        record(interpolated);
+                    }
+
+                    {
+                        int windowOffset[Kernels::maxGrains];
+                        float sourceOffset[Kernels::maxGrains];
+                        float rate[Kernels::maxGrains];
+
+                        for (int g = 0; g < Kernels::maxGrains; ++g)
+                        {
+                            windowOffset[g] = random.nextInt(16);
+                            sourceOffset[g] = random.nextFloat() * 8.0f;
+                            rate[g] = 0.5f + random.nextFloat() * 1.5f;
+                        }
+
+                        auto grains = noise(n);
+                        const auto source = noise(2 * n + 16);
+                        const auto window = noise(n + 16);
+                        table.grainOverlapAdd(grains.data(), source.data(), window.data(), windowOffset, sourceOffset, rate, n);
+
+                        // A variant may fuse rate * i into the offset add, which moves each read
+                        // position by up to an ulp; on a noise source that error grows with the position
+                        for (int i = 0; i < n; ++i)
+                        {
+                            const float sample = grains[static_cast<size_t>(i)];
+                            const float position = 8.0f + 2.0f * static_cast<float>(i);
+                            const float positionError = Kernels::maxGrains * 2.0f * position * std::numeric_limits<float>::epsilon();
+                            output.values.push_back(sample);
+                            output.scales.push_back(1.0f + std::abs(sample) + positionError / kernelTolerance);
+                        }
+                    }
+
+                    {
+                        auto io = noise(n);
+                        auto write = noise(n);
+                        const auto older = noise(n + 1);
+                        const auto shifted = noise(n);
+                        table.shimmerDelayBlock(io.data(), write.data(), older.data(), shifted.data(), random.nextFloat(),
+                                                0.3f, 0.6f, 0.4f, 0.8f, n);
+                        record(io);
+                        record(write);
+                    }
+
+                    {
+                        auto io = noise(n);
+                        const auto from = noise(n);
+                        const auto to = noise(n);
+                        table.crossfadeMixBlock(io.data(), from.data(), to.data(), fade(n).data(), 0.4f, 0.8f, n);
+                        record(io);
+                    }
+
+                    {
+                        auto io = noise(n);
+                        auto write = noise(n);
+                        const auto oldest = noise(n);
+                        table.reverseDelayBlock(io.data(), write.data(), oldest.data(), 0.6f, 0.4f, 0.8f, n);
+                        record(io);
+                        record(write);
+                    }
+
+                    {
+                        auto io = noise(n);
+                        auto write = noise(n);
+                        const auto oldest = noise(n);
+                        const auto fadingOldest = noise(n);
+                        table.reverseCrossfadeDelayBlock(io.data(), write.data(), oldest.data(), fadingOldest.data(),
+                                                         fade(n).data(), 0.6f, 0.4f, 0.8f, n);
+                        record(io);
+                        record(write);
+                    }
+
+                    {
+                        auto tap = noise(n);
+                        const auto olderFrom = noise(n + 1);
+                        const auto olderTo = noise(n + 1);
+                        auto fadeOut = fade(n);
+                        std::reverse(fadeOut.begin(), fadeOut.end());
+                        table.crossfadeTapBlock(tap.data(), olderFrom.data(), olderTo.data(), random.nextFloat(),
+                                                random.nextFloat(), fadeOut.data(), fade(n).data(), n);
+                        record(tap);
+                    }
+                }
+
+                for (int index = 0; index < Kernels::numFixedBlockSizes; ++index)
+                {
+                    const int n = Kernels::fixedBlockSizes[index];
+
+                    {
+                        auto io = noise(n);
+                        auto write = noise(n);
+                        const auto older = noise(n + 1);
+                        table.delayBlockFixed[index](io.data(), write.data(), older.data(), random.nextFloat(), 0.6f, 0.4f, 0.8f, n);
+                        record(io);
+                        record(write);
+                    }
+
+                    {
+                        auto left = noise(n);
+                        auto right = noise(n);
+                        auto midWrite = noise(n);
+                        auto sideWrite = noise(n);
+                        const auto midOlder = noise(n + 1);
+                        const auto sideOlder = noise(n + 1);
+                        table.midSideDelayBlockFixed[index](left.data(), right.data(), midWrite.data(), sideWrite.data(),
+                                                            midOlder.data(), sideOlder.data(), random.nextFloat(),
+                                                            random.nextFloat(), 0.5f, 0.7f, 0.4f, 0.8f, n);
+                        record(left);
+                        record(right);
+                        record(midWrite);
+                        record(sideWrite);
+                    }
+                }
+
+                return output;
+            }
+
+            // Each instruction set variant this CPU can run against the baseline table
+            Result checkKernelTables()
+            {
+                const auto reference = runKernelTable(Kernels::getBaselineTable());
+
+                std::vector<const Kernels::Table*> variants;
+
+               #if ECHOSPHERE_KERNELS_X86
+                variants = { &Kernels::getAVX2Table(), &Kernels::getAVX512Table() };
+               #endif
+
+                juce::StringArray compared;
+                juce::StringArray unsupported;
+                double worstError = 0.0;
+
+                for (const auto* table : variants)
+                {
+                    if (!Kernels::isSupported(table->isa))
+                    {
+                        unsupported.add(Kernels::getName(table->isa));
+                        continue;
+                    }
+
+                    const auto output = runKernelTable(*table);
+                    compared.add(Kernels::getName(table->isa));
+
+                    for (size_t i = 0; i < reference.values.size(); ++i)
+                    {
+                        const double error = std::abs(static_cast<double>(output.values[i]) - reference.values[i]) / reference.scales[i];
+
+                        // NaN compares false against everything, so fold it in by hand
+                        worstError = std::isnan(error) ? std::numeric_limits<double>::infinity() : juce::jmax(worstError, error);
+                    }
+                }
+
+                auto detail = compared.isEmpty() ? juce::String("no other variant runs on this CPU")
+                                                 : "worst error " + juce::String(worstError, 8) + " for " + compared.joinIntoString(", ");
+
+                if (!unsupported.isEmpty())
+                    detail << "; skipped " << unsupported.joinIntoString(", ");
+
+                return { worstError < kernelTolerance, detail };
+            }
+
+            // The double-mapped buffer against the copying fallback, through random block and
+            // per-sample writes, reading windows that cross the wrap point
+            Result checkRingBuffers()
+            {
+                const int maxDelay = 1000;
+                const int maxBlockSize = 64;
+                juce::Random random(0x52696e67);
+
+                MirroredRingBuffer mirrored;
+                MirroredRingBuffer copying;
+                copying.setMirroringEnabled(false);
+
+                for (auto* buffer : { &mirrored, &copying })
+                {
+                    buffer->prepare({ 48000.0, static_cast<juce::uint32>(maxBlockSize), 1 });
+                    buffer->setMaximumDelayInSamples(maxDelay);
+                }
+
+                int mismatches = 0;
+                int numReads = 0;
+
+                for (int step = 0; step < 5000; ++step)
+                {
+                    if (random.nextInt(4) == 0)
+                    {
+                        const float sample = random.nextFloat() * 2.0f - 1.0f;
+                        mirrored.pushSample(0, sample);
+                        copying.pushSample(0, sample);
+                    }
+                    else
+                    {
+                        const int numSamples = 1 + random.nextInt(maxBlockSize);
+                        auto* mirroredWrite = mirrored.getWritePointer();
+                        auto* copyingWrite = copying.getWritePointer();
+
+                        for (int i = 0; i < numSamples; ++i)
+                            mirroredWrite[i] = copyingWrite[i] = random.nextFloat() * 2.0f - 1.0f;
+
+                        mirrored.advanceWritePosition(numSamples);
+                        copying.advanceWritePosition(numSamples);
+                    }
+
+                    // Only samples already written: the capacities differ, so older ones don't match
+                    const int delay = 1 + random.nextInt(maxDelay + 1);
+                    const int length = 1 + random.nextInt(juce::jmin(delay, maxBlockSize + 1));
+                    const auto* mirroredRead = mirrored.getReadPointer(delay);
+                    const auto* copyingRead = copying.getReadPointer(delay);
+
+                    for (int i = 0; i < length; ++i)
+                        if (mirroredRead[i] != copyingRead[i])
+                            ++mismatches;
+
+                    // A delay under one sample would interpolate towards the slot about to be written
+                    const float fractionalDelay = 1.0f + random.nextFloat() * static_cast<float>(maxDelay - 1);
+
+                    if (mirrored.popSample(0, fractionalDelay) != copying.popSample(0, fractionalDelay))
+                        ++mismatches;
+
+                    numReads += length + 1;
+                }
+
+                auto detail = juce::String(mismatches) + " of " + juce::String(numReads) + " samples differ";
+
+                if (!mirrored.isMirrored())
+                    detail << " (double mapping unavailable here, so both used the fallback)";
+
+                return { mismatches == 0 && !copying.isMirrored(), detail };
+            }
+
+            // Random settings saved by one processor and restored into fresh ones, through the
+            // binary format and through the parameter XML that sessions from older builds hold
+            Result checkStateRoundTrip()
+            {
+                juce::Random random(0x53746174);
+                EchoSphereAudioProcessor source;
+
+                for (const auto& descriptor : parameterDescriptors)
+                    source.getParameterTree().getParameter(descriptor.id)->setValueNotifyingHost(random.nextFloat());
+
+                // A real impulse response file, so its path goes through the state as well
+                juce::TemporaryFile impulseFile(".wav");
+
+                {
+                    juce::AudioBuffer<float> impulse(1, 512);
+                    fillWithNoise(impulse, random);
+
+                    juce::WavAudioFormat format;
+                    std::unique_ptr<juce::FileOutputStream> stream(impulseFile.getFile().createOutputStream());
+                    std::unique_ptr<juce::AudioFormatWriter> writer;
+
+                    if (stream != nullptr)
+                        writer.reset(format.createWriterFor(stream.get(), 48000.0, 1, 24, {}, 0));
+
+                    if (writer == nullptr)
+                        return { false, "could not write " + impulseFile.getFile().getFullPathName() };
+
+                    stream.release(); // now owned by the writer
+                    writer->writeFromAudioSampleBuffer(impulse, 0, impulse.getNumSamples());
+                }
+
+                if (!source.loadReverbImpulseResponse(impulseFile.getFile()))
+                    return { false, "could not load " + impulseFile.getFile().getFullPathName() };
+
+                juce::StringArray differences;
+
+                auto compare = [&source, &differences](EchoSphereAudioProcessor& restored, const juce::String& format)
+                {
+                    for (const auto& descriptor : parameterDescriptors)
+                    {
+                        const float expected = source.getParameterValue(descriptor.index);
+                        const float actual = restored.getParameterValue(descriptor.index);
+
+                        if (std::abs(actual - expected) > 1.0e-4f * juce::jmax(1.0f, descriptor.maxValue - descriptor.minValue))
+                            differences.add(format + " " + descriptor.id + " " + juce::String(actual) + " (saved " + juce::String(expected) + ")");
+                    }
+
+                    if (restored.getParameterTree().state.getProperty("reverb_ir") != source.getParameterTree().state.getProperty("reverb_ir"))
+                        differences.add(format + " impulse response path");
+                };
+
+                juce::MemoryBlock binaryState;
+                source.getStateInformation(binaryState);
+
+                EchoSphereAudioProcessor fromBinary;
+                fromBinary.setStateInformation(binaryState.getData(), static_cast<int>(binaryState.getSize()));
+                compare(fromBinary, "binary");
+
+                // What getStateInformation wrote before the binary format
+                juce::MemoryBlock xmlState;
+
+                if (auto xml = source.getParameterTree().copyState().createXml())
+                    juce::AudioProcessor::copyXmlToBinary(*xml, xmlState);
+
+                EchoSphereAudioProcessor fromXml;
+                fromXml.setStateInformation(xmlState.getData(), static_cast<int>(xmlState.getSize()));
+                compare(fromXml, "XML");
+
+                if (differences.isEmpty())
+                    return { true, juce::String(ParamIndex::NUM_PARAMETERS) + " parameters and the impulse response path restored from both formats" };
+
+                return { false, differences.joinIntoString("; ") };
+            }
+
+            // A sine through the delay while its time changes at block starts, inside blocks,
+            // during an earlier fade and via scheduleDelayTime, at full and half wet path rate.
+            // No output step may exceed what the sine and the crossfade ramp produce themselves.
+            Result checkDelayRetarget()
+            {
+                const double sampleRate = 48000.0;
+                const int blockSize = 256;
+                const int numBlocks = 200;
+                const double frequency = 220.0;
+                const double phaseIncrement = juce::MathConstants<double>::twoPi * frequency / sampleRate;
+
+                // The equal-power fade turns a quarter cycle over its length, so mixing two unit
+                // sines moves at most sqrt(2) times the sine's slope plus the fade's. An unfaded
+                // jump can be as large as 2 in one sample.
+                const int fadeLength = juce::roundToInt(DelayLine::retargetFadeMs * 0.001 * sampleRate);
+                const double allowedStep = 1.05 * juce::MathConstants<double>::sqrt2
+                                         * (phaseIncrement + juce::MathConstants<double>::halfPi / fadeLength);
+
+                // Negative offset: setDelayTime at the block start
+                struct Change
+                {
+                    int block;
+                    float delayMs;
+                    int sampleOffset;
+                };
+
+                const Change changes[] = {
+                    { 60, 202.27f, -1 },  // half a period on from 200 ms
+                    { 64, 351.0f, 100 },
+                    { 65, 120.0f, -1 },   // while the previous fade runs
+                    { 80, 733.0f, 300 },  // scheduled into the next block
+                    { 100, 5.0f, 17 },    // shorter than a block
+                    { 120, 480.0f, -1 }
+                };
+
+                double worstStep = 0.0;
+                double worstSettledError = 0.0;
+
+                for (const int wetPathDivisor : { 1, 2 })
+                {
+                    DelayLine delay;
+                    delay.prepare(sampleRate, blockSize, wetPathDivisor);
+                    delay.setFeedback(0.0f);
+                    delay.setMix(100.0f);
+                    delay.setDelayTime(200.0f);
+
+                    juce::AudioBuffer<float> buffer(1, blockSize);
+                    float previous = 0.0f;
+                    int sampleIndex = 0;
+
+                    for (int block = 0; block < numBlocks; ++block)
+                    {
+                        for (const auto& change : changes)
+                        {
+                            if (change.block != block)
+                                continue;
+
+                            if (change.sampleOffset < 0)
+                                delay.setDelayTime(change.delayMs);
+                            else
+                                delay.scheduleDelayTime(change.delayMs, change.sampleOffset);
+                        }
+
+                        for (int i = 0; i < blockSize; ++i)
+                            buffer.setSample(0, i, static_cast<float>(std::sin(phaseIncrement * (sampleIndex + i))));
+
+                        delay.processBlock(buffer, 0);
+
+                        for (int i = 0; i < blockSize; ++i, ++sampleIndex)
+                        {
+                            const float sample = buffer.getSample(0, i);
+                            worstStep = juce::jmax(worstStep, static_cast<double>(std::abs(sample - previous)));
+                            previous = sample;
+
+                            // Long after the last change the output must be the input 480 ms ago,
+                            // or the changes never took effect
+                            if (block >= numBlocks - 20)
+                            {
+                                const double expected = std::sin(phaseIncrement * (sampleIndex - 0.48 * sampleRate));
+                                worstSettledError = juce::jmax(worstSettledError, std::abs(sample - expected));
+                            }
+                        }
+
+                        if (std::isnan(previous))
+                            return { false, "output is NaN" };
+                    }
+                }
+
+                return { worstStep <= allowedStep && worstSettledError < 0.02,
+                         "worst step " + juce::String(worstStep, 5) + " (" + juce::String(allowedStep, 5)
+                             + " allowed), settled error " + juce::String(worstSettledError, 5) };
+            }
+        }
+
+        int run(const std::function<void(const juce::String&)>& log)
+        {
+            struct Check
+            {
+                const char* name;
+                Result (*function)();
+            };
+
+            const Check checks[] = {
+                { "Convolution reverb matches direct convolution", checkConvolution },
+                { "Kernel variants match the baseline table", checkKernelTables },
+                { "Mirrored and copying ring buffers read the same samples", checkRingBuffers },
+                { "Binary state round-trips and XML state from older builds loads", checkStateRoundTrip },
+                { "Delay time changes crossfade without discontinuities", checkDelayRetarget }
+            };
+
+            int failures = 0;
+
+            for (const auto& check : checks)
+            {
+                const auto result = check.function();
+                log(juce::String(result.passed ? "PASS  " : "FAIL  ") + check.name + ": " + result.detail);
+
+                if (!result.passed)
+                    ++failures;
+            }
+
+            const int numChecks = static_cast<int>(std::size(checks));
+            log(juce::String(numChecks - failures) + " of " + juce::String(numChecks) + " checks passed");
+            return failures;
+        }
+    }
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "JuceHeader.h"
+
+namespace EchoSphere
+{
+    // Offline checks of the DSP against slow, plainly written reference versions. Run by
+    // EchoSphereRender --self-test (which is what ctest runs); no audio device or input
+    // files needed.
+    namespace SelfTest
+    {
+        // Runs every check, reporting each one through log. Returns the number that failed.
+        int run(const std::function<void(const juce::String&)>& log);
+    }
+}